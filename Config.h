@@ -9,8 +9,8 @@ using namespace std;
  * Input and Output  
 */
 
-// whether to write answers to file
-#define WRITE_ANSWERS
+// default answer output (text/binary/zstd/none), can be changed by --output
+string answerOutput = "text";
 
 // answer file relative path
 string answerPath = "Results/Answers/";
@@ -18,6 +18,9 @@ string answerPath = "Results/Answers/";
 // whether to write statistics logs to file
 #define WRITE_STATISTICS
 
+// whether to write work counters of each query to a JSON lines file in statisticsPath, can be changed by --trace
+bool writeTrace = false;
+
 // statistics file relative path
 string statisticsPath = "Results/Statistics/";
 
@@ -39,6 +42,17 @@ typedef unsigned int VertexID;
 // integer type for Edge IDs (related to graph max size)
 typedef unsigned int EdgeID;
 
+// integer type for epoch stamps of per-query arrays, 64-bit if built with "make EPOCH=64"
+// 32-bit stamps wrap around every about 2^31/(kMax+1) queries, when all stamped arrays are cleared at once
+// 64-bit stamps never wrap around in practice, while stamped arrays take twice the memory
+#if defined(EPOCH_BITS) && EPOCH_BITS==64
+    typedef long long Epoch;
+    const Epoch maxEpoch = 9223372036854775807LL;
+#else
+    typedef int Epoch;
+    const Epoch maxEpoch = 2147483647;
+#endif
+
 
 
 #endif
\ No newline at end of file
@@ -0,0 +1,26 @@
+#include "../../GraphUtils/Graph.cc"
+#include<cstdlib>
+using namespace std;
+
+
+int main(int argc, char *argv[]) {    
+
+    // program input parameters
+    if(argc < 2) {
+        cout << "Usage: ./ConvertGraph <Graph File>" << endl;
+        exit(1);
+    }
+    graphFilename = extractFilename(argv[1]); 
+
+    // load the text graph and build CSR arrays
+    Graph* graph = new Graph(("../"+graphFilename).c_str());
+
+    // write binary graph file next to the text graph file
+    string outputFilename = "../"+graphFilename+".bin";
+    cout<<"Writing binary graph file: "<<outputFilename<<" ..."<<endl;
+    double startTime = getCurrentTimeInMs();
+    graph->writeBinaryGraphFile(outputFilename.c_str());
+    printf("- Finish. time cost: %.2f ms\n", getCurrentTimeInMs()-startTime);
+
+    return 0;    
+}
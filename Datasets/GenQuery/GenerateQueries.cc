@@ -18,16 +18,18 @@ int main(int argc, char *argv[]) {
     // initialize the graph
     Graph* graph = new Graph(("../"+graphFilename).c_str());
     VertexID VN = graph->VN;
-    PerNeighbor* outNeighbors = graph->outNeighbors;
+    VertexID* outNeighbors = graph->outNeighbors;
     EdgeID* outNeighborsLocator = graph->outNeighborsLocator;
 
     // initialization for query generation
     VertexID* frontier = new VertexID[VN];
     VertexID frontierEnd;
-    nextFrontier = new VertexID[VN];
+    VertexID* nextFrontier = new VertexID[VN];
+    VertexID nextFrontierEnd;
     VertexID* visitedVertices = new VertexID[VN];
     VertexID visitedVerticesEnd = 0;
     int* isVisited = new int[VN]();
+    int offset = 0;
     vector<vector<PerQuery>> queries;
     for (int i=0; i<=maxLen; i++)
         queries.push_back({});
@@ -58,7 +60,7 @@ int main(int argc, char *argv[]) {
             for (int i=0; i<frontierEnd; i++) {
                 VertexID& u = frontier[i];
                 for (EdgeID locator=outNeighborsLocator[u]; locator<outNeighborsLocator[u+1]; locator++) {
-                    VertexID& v = outNeighbors[locator].neighbor;
+                    VertexID& v = outNeighbors[locator];
 
                     if (isVisited[v]<offset) {
                         isVisited[v] = offset;
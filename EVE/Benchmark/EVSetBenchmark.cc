@@ -0,0 +1,113 @@
+#include "../EVE.cc"
+using namespace std;
+
+
+
+// run all queries with current kernels, return the best time of rounds and the total number of answer edges
+double runQueries(EVE* method, vector<PerQuery>& queries, int rounds, unsigned long long& answerEdges) {
+    double bestTime = -1;
+    for (int round=0; round<rounds; round++) {
+        answerEdges = 0;
+        double startTime = getCurrentTimeInMs();
+        for (PerQuery& query : queries)
+            answerEdges += method->executeQuery(query.source, query.target, query.k);
+        double timeCost = getCurrentTimeInMs()-startTime;
+        if (bestTime<0 || timeCost<bestTime)
+            bestTime = timeCost;
+    }
+    return bestTime;
+}
+
+
+
+// random sorted sets of essential vertices with lengths in [1, maxLength], half of the pairs are disjoint
+void generateSetPairs(int pairNumber, int maxLength, VertexID VN, vector<VertexID>& pool, vector<int>& starts, vector<int>& lengths) {
+    mt19937 generator(20230615);
+    uniform_int_distribution<int> lengthDistribution(1, maxLength);
+    uniform_int_distribution<VertexID> vertexDistribution(0, VN-1);
+    for (int i=0; i<pairNumber*2; i++) {
+        int length = lengthDistribution(generator);
+        starts.push_back(pool.size());
+        lengths.push_back(length);
+        set<VertexID> vertices;
+        if (i%4==3)
+            vertices.insert(pool[starts[i-1]+vertexDistribution(generator)%lengths[i-1]]);
+        while ((int)vertices.size()<length)
+            vertices.insert(vertexDistribution(generator));
+        pool.insert(pool.end(), vertices.begin(), vertices.end());
+    }
+}
+
+
+
+int main(int argc, char *argv[]) {    
+
+    // program input parameters
+    if(argc < 4) {
+        cout << "Usage: ./EVSetBenchmark <Graph File> <Query File> <Hop Constraint k> [--rounds=<Number of Rounds>]" << endl;
+        exit(1);
+    }
+    graphFilename = extractFilename(argv[1]); 
+    queryFilename = extractFilename(argv[2]); 
+    maxLen = stoi(argv[3]);
+    kMax = maxLen;
+    int rounds = stoi(getOption(argc, argv, "rounds", "3"));
+
+    // graph, queries and EVE
+    Graph* graph = new Graph(("../../"+datasetPath+graphFilename).c_str());
+    vector<PerQuery> queries;
+    loadQueries(("../../"+datasetPath+queryFilename).c_str(), queries);
+    EVE* method = new EVE(graph);
+
+    // random set pairs as in edge labeling
+    vector<VertexID> pool;
+    vector<int> starts, lengths;
+    int pairNumber = 1<<20;
+    generateSetPairs(pairNumber, max(kMax-2, 1), graph->VN, pool, starts, lengths);
+
+    // compare kernels
+    const char* kernels[3] = {"scalar", "avx2", "avx512"};
+    double baseQueryTime = 0, baseKernelTime = 0;
+    unsigned long long baseAnswerEdges = 0;
+    printf("%-8s %16s %10s %16s %10s\n", "kernels", "queries (ms)", "speedup", "set pairs (ms)", "speedup");
+    for (short i=0; i<3; i++) {
+        if (!selectEVSetKernels(kernels[i])) {
+            printf("%-8s not supported by CPU\n", kernels[i]);
+            continue;
+        }
+
+        // all queries
+        unsigned long long answerEdges;
+        double queryTime = runQueries(method, queries, rounds, answerEdges);
+
+        // disjointness and membership tests on random set pairs
+        double kernelTime = -1;
+        unsigned long long disjointPairs = 0;
+        for (int round=0; round<rounds; round++) {
+            disjointPairs = 0;
+            double startTime = getCurrentTimeInMs();
+            for (int j=0; j<pairNumber*2; j+=2) {
+                disjointPairs += isDisjointEV(&pool[starts[j]], lengths[j], &pool[starts[j+1]], lengths[j+1]);
+                disjointPairs += containsEV(&pool[starts[j]], lengths[j], pool[starts[j+1]]);
+            }
+            double timeCost = getCurrentTimeInMs()-startTime;
+            if (kernelTime<0 || timeCost<kernelTime)
+                kernelTime = timeCost;
+        }
+
+        // results should be the same for all kernels
+        if (i==0) {
+            baseQueryTime = queryTime;
+            baseKernelTime = kernelTime;
+            baseAnswerEdges = answerEdges+disjointPairs;
+        } else if (answerEdges+disjointPairs!=baseAnswerEdges) {
+            printf("! Results of %s kernels differ from scalar kernels\n", kernels[i]);
+            exit(1);
+        }
+        printf("%-8s %16.2f %9.2fx %16.2f %9.2fx\n", kernels[i], queryTime, queryTime>0 ? baseQueryTime/queryTime : 1.0, 
+               kernelTime, kernelTime>0 ? baseKernelTime/kernelTime : 1.0);
+    }
+    method->cleanUp();
+
+    return 0;    
+}
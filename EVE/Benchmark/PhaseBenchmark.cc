@@ -0,0 +1,200 @@
+#include "../EVE.cc"
+using namespace std;
+
+
+
+// synthetic graph families
+Graph* generatePowerLawGraph(VertexID VN, int degree, mt19937& generator);
+Graph* generateGridGraph(VertexID VN, mt19937& generator);
+Graph* generateDAG(VertexID VN, int degree, mt19937& generator);
+
+// queries from random walks of k hops, so that t is reachable from s within k hops
+void generateQueries(Graph* graph, short k, int queryNumber, mt19937& generator, vector<PerQuery>& queries);
+
+// time each phase of queries and print p50/p99/max
+void benchmarkPhases(string graphName, Graph* graph, short firstK, short lastK, int queryNumber, mt19937& generator);
+
+
+
+int main(int argc, char *argv[]) {
+
+    // program input parameters
+    if(argc >= 2 && string(argv[1]).compare(0, 2, "--")!=0) {
+        cout << "Usage: ./PhaseBenchmark [--graph=<Graph File>] [--family=<powerlaw|grid|dag|all>] [--vertices=<Number of Vertices>] "
+             << "[--degree=<Average Degree>] [--queries=<Number of Queries>] [--kmin=<Min k>] [--kmax=<Max k>] [--order=<none|degree|bfs|rcm>] [--bottomup=<on|off>]" << endl;
+        exit(1);
+    }
+    string graphOption = getOption(argc, argv, "graph", "");
+    string family = getOption(argc, argv, "family", "all");
+    VertexID VN = stoul(getOption(argc, argv, "vertices", "10000"));
+    int degree = stoi(getOption(argc, argv, "degree", "4"));
+    int queryNumber = stoi(getOption(argc, argv, "queries", "100"));
+    short kMin = stoi(getOption(argc, argv, "kmin", "3"));
+    kMax = stoi(getOption(argc, argv, "kmax", "10"));
+    maxLen = kMax;
+    vertexOrder = getOption(argc, argv, "order", vertexOrder);
+    bottomUpBFS = getOption(argc, argv, "bottomup", bottomUpBFS ? "on" : "off")=="on";
+    mt19937 generator(20230615);
+
+    // graph in Datasets/
+    if (!graphOption.empty()) {
+        graphFilename = extractFilename(graphOption);
+        Graph* graph = new Graph(("../../"+datasetPath+graphFilename).c_str());
+        graph->reorderVertices(vertexOrder);
+        benchmarkPhases(graphFilename, graph, kMin, kMax, queryNumber, generator);
+        graph->cleanUp();
+        return 0;
+    }
+
+    // synthetic graphs
+    if (family=="powerlaw" || family=="all") {
+        Graph* graph = generatePowerLawGraph(VN, degree, generator);
+        graph->reorderVertices(vertexOrder);
+        benchmarkPhases("powerlaw", graph, kMin, kMax, queryNumber, generator);
+        graph->cleanUp();
+    }
+    if (family=="grid" || family=="all") {
+        Graph* graph = generateGridGraph(VN, generator);
+        graph->reorderVertices(vertexOrder);
+        benchmarkPhases("grid", graph, kMin, kMax, queryNumber, generator);
+        graph->cleanUp();
+    }
+    if (family=="dag" || family=="all") {
+        Graph* graph = generateDAG(VN, degree, generator);
+        graph->reorderVertices(vertexOrder);
+        benchmarkPhases("dag", graph, kMin, kMax, queryNumber, generator);
+        graph->cleanUp();
+    }
+
+    return 0;
+}
+
+
+
+// preferential attachment, each new vertex links to degree vertices picked by their degrees, in random directions
+Graph* generatePowerLawGraph(VertexID VN, int degree, mt19937& generator) {
+    vector<pair<VertexID, VertexID>> edges;
+    vector<VertexID> endpoints;
+    for (VertexID v=1; v<VN; v++) {
+        for (int i=0; i<degree && i<(int)v; i++) {
+            VertexID u = endpoints.empty() ? 0 : endpoints[generator()%endpoints.size()];
+            if (u==v)
+                continue;
+            if (generator()%2)
+                edges.push_back({u, v});
+            else
+                edges.push_back({v, u});
+            endpoints.push_back(u);
+            endpoints.push_back(v);
+        }
+    }
+    return new Graph(VN, edges);
+}
+
+
+
+// square grid, each pair of adjacent vertices is linked in a random direction, and also in the other direction with probability 1/4
+Graph* generateGridGraph(VertexID VN, mt19937& generator) {
+    vector<pair<VertexID, VertexID>> edges;
+    VertexID side = max((VertexID)sqrt((double)VN), (VertexID)2);
+    for (VertexID row=0; row<side; row++)
+        for (VertexID column=0; column<side; column++) {
+            VertexID u = row*side+column;
+            VertexID neighbors[2] = {column+1<side ? u+1 : u, row+1<side ? u+side : u};
+            for (VertexID& v : neighbors) {
+                if (v==u)
+                    continue;
+                bool isForward = generator()%2;
+                edges.push_back(isForward ? make_pair(u, v) : make_pair(v, u));
+                if (generator()%4==0)
+                    edges.push_back(isForward ? make_pair(v, u) : make_pair(u, v));
+            }
+        }
+    return new Graph(side*side, edges);
+}
+
+
+
+// random DAG, each vertex links to degree vertices with larger ids within a window, so that long paths exist
+Graph* generateDAG(VertexID VN, int degree, mt19937& generator) {
+    vector<pair<VertexID, VertexID>> edges;
+    VertexID window = 64;
+    for (VertexID u=0; u+1<VN; u++)
+        for (int i=0; i<degree; i++) {
+            VertexID v = u+1+generator()%window;
+            if (v<VN)
+                edges.push_back({u, v});
+        }
+    return new Graph(VN, edges);
+}
+
+
+
+// queries from random walks of k hops, so that t is reachable from s within k hops
+void generateQueries(Graph* graph, short k, int queryNumber, mt19937& generator, vector<PerQuery>& queries) {
+    queries.clear();
+    for (long long attempt=0; (int)queries.size()<queryNumber && attempt<(long long)queryNumber*1000; attempt++) {
+        VertexID s = generator()%graph->VN;
+        VertexID t = s;
+        for (short hop=0; hop<k; hop++) {
+            EdgeID degree = graph->outNeighborsLocator[t+1]-graph->outNeighborsLocator[t];
+            if (degree==0)
+                break;
+            t = graph->outNeighbors[graph->outNeighborsLocator[t]+generator()%degree];
+        }
+        if (t!=s)
+            queries.push_back({s, t, k});
+    }
+}
+
+
+
+// value at percentile p of sorted values
+double getPercentile(vector<double>& sortedValues, double p) {
+    size_t index = (size_t)ceil(p*sortedValues.size());
+    return sortedValues[index>0 ? index-1 : 0];
+}
+
+
+
+// time each phase of queries and print p50/p99/max
+void benchmarkPhases(string graphName, Graph* graph, short firstK, short lastK, int queryNumber, mt19937& generator) {
+    printf("\n%s: |V|=%u, |E|=%u\n", graphName.c_str(), graph->VN, graph->EN);
+    printf("%-28s %10s %12s %12s %12s\n", "Benchmark", "Queries", "p50 (ms)", "p99 (ms)", "max (ms)");
+    printf("------------------------------------------------------------------------------\n");
+    EVE* method = new EVE(graph);
+    method->recordPhaseTimes = true;
+    vector<PerQuery> queries;
+    for (short k=firstK; k<=lastK; k++) {
+        generateQueries(graph, k, queryNumber, generator, queries);
+        if (queries.empty()) {
+            printf("%s/k=%d: no query found\n", graphName.c_str(), k);
+            continue;
+        }
+
+        // phase times of each query, the last one is the total time
+        vector<vector<double>> times(EVEPhaseNumber+1);
+        unsigned long long answerEdges = 0;
+        for (PerQuery& query : queries) {
+            answerEdges += method->executeQuery(query.source, query.target, query.k);
+            double totalTime = 0;
+            for (int phase=0; phase<EVEPhaseNumber; phase++) {
+                times[phase].push_back(method->phaseTimes[phase]);
+                totalTime += method->phaseTimes[phase];
+            }
+            times[EVEPhaseNumber].push_back(totalTime);
+        }
+
+        // p50, p99 and max of each phase
+        for (int phase=0; phase<=EVEPhaseNumber; phase++) {
+            sort(times[phase].begin(), times[phase].end());
+            string name = graphName+"/k="+to_string(k)+"/"+(phase<EVEPhaseNumber ? EVEPhaseNames[phase] : "total");
+            printf("%-28s %10zu %12.4f %12.4f %12.4f\n", name.c_str(), queries.size(),
+                   getPercentile(times[phase], 0.5), getPercentile(times[phase], 0.99), times[phase].back());
+        }
+        printf("%-28s %10zu %12.1f\n", (graphName+"/k="+to_string(k)+"/answer edges").c_str(), queries.size(), (double)answerEdges/queries.size());
+        fflush(stdout);
+    }
+    method->cleanUp();
+    delete method;
+}
@@ -9,16 +9,28 @@ EVE::EVE(Graph* inputGraph) {
 
     // basic graph information
     graph = inputGraph;
+    loadGraph();
+    
+    // initialization
+    initEVE();
+}
+
+
+
+// basic graph information, reloaded when arrays of a dynamic graph are moved
+void EVE::loadGraph() {
     VN = graph->VN;
     EN = graph->EN;
     edges = graph->edges;
     inNeighborsLocator = graph->inNeighborsLocator;
+    inNeighborsLocatorEnd = graph->inNeighborsLocatorEnd;
     inNeighbors = graph->inNeighbors;
+    inNeighborEdgeIds = graph->inNeighborEdgeIds;
     outNeighborsLocator = graph->outNeighborsLocator;
+    outNeighborsLocatorEnd = graph->outNeighborsLocatorEnd;
     outNeighbors = graph->outNeighbors;
-    
-    // initialization
-    initEVE();
+    outNeighborEdgeIds = graph->outNeighborEdgeIds;
+    layoutVersion = graph->layoutVersion;
 }
 
 
@@ -30,98 +42,358 @@ void EVE::answerAllQueries(vector<PerQuery>& queries) {
         return;
     }
     
-    // answers and statistics file
-    #ifdef WRITE_ANSWERS
-        resultFile.open("../"+answerPath+queryFilename+getParaString()+".EVE.answer");
-        resultFile<<"number of edges,edge ids"<<endl;
-    #endif
+    // answers, undetermined edges, traces and statistics file
+    vector<QueryOutput> outputs(queries.size());
+    bool isTagging = isUpperboundAnswer && tagUndetermined;
+    AnswerWriter answerWriter(answerOutput, "../"+answerPath+queryFilename+getParaString());
+    AnswerWriter undeterminedWriter(isTagging ? answerOutput : "none", "../"+answerPath+queryFilename+getParaString()+".undetermined");
+    ofstream traceFile;
+    if (writeTrace) {
+        traceFile.open("../"+statisticsPath+queryFilename+getParaString()+".trace.jsonl");
+        if (!traceFile.is_open()) {
+            printf("! Can not write trace file: %s\n", ("../"+statisticsPath+queryFilename+getParaString()+".trace.jsonl").c_str());
+            exit(1);
+        }
+    }
     #ifdef WRITE_STATISTICS
-        queryId = 0;
         initStatisticStorage(queries.size());
     #endif
 
-    // initialization
-    printf("Running EVE ...\n");
-    double startTime = getCurrentTimeInMs();
-
-    // iterate each query
-    for (PerQuery& query : queries) {
-
-        // execute each query
-        resultEnd = executeQuery(query.source, query.target, maxLen);
-        
-        // sort and write results to file
-        #ifdef WRITE_ANSWERS
-            sort(results, results+resultEnd);
-            resultFile<<resultEnd;
-            for (EdgeID j=0; j<resultEnd; j++)
-                resultFile<<","<<results[j];
-            resultFile<<endl;
-        #endif
+    // workers sharing the read-only graph, each with its own query context
+    int threadNumber = min(getThreadNumber(), int(queries.size()));
+    vector<EVE*> workers(1, this);
+    for (int i=1; i<threadNumber; i++) {
+        workers.push_back(new EVE(graph));
         #ifdef WRITE_STATISTICS
-            queryId++;
+            workers[i]->numOfUpperbound = numOfUpperbound;
+            workers[i]->numOfAnswers = numOfAnswers;
+            workers[i]->spaceCosts = spaceCosts;
         #endif
     }
+    if (writeTrace)
+        for (EVE* worker : workers)
+            worker->trace = new QueryTrace();
+
+    // cores not used by other workers go to large frontiers and candidates of each query
+    for (EVE* worker : workers)
+        worker->intraQueryThreads = getIntraQueryThreadNumber(threadNumber);
+
+    // index rejecting queries without path of k hops
+    if (landmarkNumber>0) {
+        printf("Building index with %d landmarks ...\n", landmarkNumber);
+        landmarkIndex = new LandmarkIndex(graph, landmarkNumber);
+        printf("- Finish. Index build time: %.2f ms, index size: %.2f MB\n", landmarkIndex->buildTime, landmarkIndex->getSize()/1048576.0);
+        for (EVE* worker : workers)
+            worker->landmarkIndex = landmarkIndex;
+    }
+
+    // answers cached across queries, except upperbound answers with undetermined edges
+    if (resultCacheSize>0 && !isTagging) {
+        resultCache = new ResultCache(resultCacheSize<<20, !isUpperboundAnswer);
+        for (EVE* worker : workers)
+            worker->resultCache = resultCache;
+    }
+
+    // outputs are written in input order as soon as all former queries finish
+    Scheduler scheduler(queries.size(), threadNumber, [&outputs, &answerWriter, &undeterminedWriter, &traceFile](size_t queryIndex) {
+        QueryOutput& output = outputs[queryIndex];
+        answerWriter.writeAnswer(output.answer);
+        undeterminedWriter.writeAnswer(output.undeterminedEdges);
+        if (writeTrace)
+            traceFile<<output.trace<<"\n";
+        output = QueryOutput();
+    });
+
+    // initialization
+    printf("Running EVE with %d threads ...\n", threadNumber);
+    double startTime = getCurrentTimeInMs();
+
+    // queries are handed out dynamically, idle workers steal from busy ones
+    vector<thread> threads;
+    for (int i=1; i<threadNumber; i++)
+        threads.push_back(thread(&EVE::answerQueriesByWorker, workers[i], i, &queries, &scheduler, &outputs));
+    answerQueriesByWorker(0, &queries, &scheduler, &outputs);
+    for (thread& worker : threads)
+        worker.join();
+    scheduler.cleanUp();
 
     // output logs
     double timeCost = getCurrentTimeInMs() - startTime;
     printf("- Finish. Time cost: %.2f ms\n", timeCost);
-    logFile<<str(timeCost)<<endl;
-
-    // output answers and statistics file
-    #ifdef WRITE_ANSWERS
-        resultFile.close();
-    #endif
+    logFile<<str(timeCost);
+    if (resultCache) {
+        printf("- Result cache: %llu hits, %llu misses, hit rate %.2f%%\n", resultCache->hits, resultCache->misses, resultCache->getHitRate()*100);
+        logFile<<","<<resultCache->hits<<","<<resultCache->misses<<","<<str(resultCache->getHitRate()*100);
+    }
+    if (landmarkIndex)
+        logFile<<","<<str(landmarkIndex->buildTime)<<","<<landmarkIndex->getSize();
+    logFile<<endl;
+
+    // output answers, traces and statistics file
+    answerWriter.close();
+    undeterminedWriter.close();
+    if (writeTrace)
+        traceFile.close();
     #ifdef WRITE_STATISTICS
-        for (short i=0; i<queries.size(); i++) 
+        for (size_t i=0; i<queries.size(); i++) 
             statisticsFile<<spaceCosts[i]<<","<<numOfUpperbound[i]<<","<<numOfAnswers[i]<<endl;
         cleanUpStatisticStorage();
     #endif
+
+    // free up traces and other workers
+    if (writeTrace)
+        for (EVE* worker : workers) {
+            delete worker->trace;
+            worker->trace = NULL;
+        }
+    for (int i=1; i<threadNumber; i++) {
+        workers[i]->cleanUp();
+        delete workers[i];
+    }
+    if (resultCache) {
+        delete resultCache;
+        resultCache = NULL;
+    }
+    if (landmarkIndex) {
+        landmarkIndex->cleanUp();
+        delete landmarkIndex;
+        landmarkIndex = NULL;
+    }
 }      
 
 
 
+// answer queries handed out by the scheduler with this worker
+void EVE::answerQueriesByWorker(int workerId, vector<PerQuery>* queries, Scheduler* scheduler, vector<QueryOutput>* outputs) {
+    size_t i;
+    while (scheduler->getTask(workerId, i)) {
+        PerQuery& query = (*queries)[i];
+        QueryOutput& output = (*outputs)[i];
+
+        // execute each query, keeping sorted results until written in input order
+        if (batchQueries)
+            prepareSharedBall(*queries, i);
+        if (answerOutput=="none" && resultCache==NULL)
+            resultEnd = executeQuery(query.source, query.target, query.k);
+        else if (isUpperboundAnswer && tagUndetermined)
+            answerQuery(query.source, query.target, query.k, output.answer, output.undeterminedEdges);
+        else
+            answerQuery(query.source, query.target, query.k, output.answer);
+        #ifdef WRITE_STATISTICS
+            numOfUpperbound[i] = upperboundCount;
+            numOfAnswers[i] = resultEnd; 
+            spaceCosts[i] = getCurrentSpaceCost();
+        #endif
+        if (trace)
+            output.trace = trace->toJSON();
+        scheduler->finishTask(i);
+    }
+    sharedBall = NULL;
+}
+
+
+
+// answer a single query with sorted edge ids, e.g., for server mode
+void EVE::answerQuery(VertexID source, VertexID target, short k, vector<EdgeID>& answer) {
+
+    // answered by cache without any phase
+    if (resultCache && resultCache->lookup(source, target, k, answer)) {
+        resultEnd = definiteEnd = answer.size();
+        #ifdef WRITE_STATISTICS
+            upperboundCount = 0;
+            isAnsweredWithoutPhases = true;
+        #endif
+        memset(phaseTimes, 0, sizeof(phaseTimes));
+        if (trace) {
+            trace->reset(graph->getOriginalId(source), graph->getOriginalId(target), k);
+            trace->cacheHit = true;
+            trace->answerEdges = resultEnd;
+        }
+        return;
+    }
+
+    resultEnd = executeQuery(source, target, k);
+    sort(results, results+resultEnd);
+    answer.assign(results, results+resultEnd);
+    if (resultCache)
+        resultCache->insert(source, target, k, results, resultEnd);
+}
+
+
+
+// answer a single query with sorted edge ids, and sorted edge ids of undetermined edges for upperbound answers
+void EVE::answerQuery(VertexID source, VertexID target, short k, vector<EdgeID>& answer, vector<EdgeID>& undeterminedEdges) {
+    resultEnd = executeQuery(source, target, k);
+    undeterminedEdges.assign(results+definiteEnd, results+resultEnd);
+    sort(undeterminedEdges.begin(), undeterminedEdges.end());
+    sort(results, results+resultEnd);
+    answer.assign(results, results+resultEnd);
+}
+
+
+
+// answer queries grouped by source, and the others grouped by target, with answers of sorted edge ids in input order
+void EVE::answerQueryBatch(vector<PerQuery>& queries, vector<vector<EdgeID>>& answers) {
+    answers.resize(queries.size());
+
+    // group by source, queries alone are then grouped by target
+    vector<size_t> order, alone;
+    for (size_t i=0; i<queries.size(); i++)
+        alone.push_back(i);
+    stable_sort(alone.begin(), alone.end(), [&queries](size_t a, size_t b) { return queries[a].source<queries[b].source; });
+    for (size_t i=0, runEnd; i<alone.size(); i=runEnd) {
+        for (runEnd=i+1; runEnd<alone.size() && queries[alone[runEnd]].source==queries[alone[i]].source; runEnd++);
+        if (runEnd-i>=2) {
+            order.insert(order.end(), alone.begin()+i, alone.begin()+runEnd);
+            fill(alone.begin()+i, alone.begin()+runEnd, queries.size());
+        }
+    }
+    alone.erase(remove(alone.begin(), alone.end(), queries.size()), alone.end());
+    stable_sort(alone.begin(), alone.end(), [&queries](size_t a, size_t b) { return queries[a].target<queries[b].target; });
+    order.insert(order.end(), alone.begin(), alone.end());
+
+    // answer in group order
+    vector<PerQuery> groupedQueries;
+    for (size_t& i : order)
+        groupedQueries.push_back(queries[i]);
+    for (size_t i=0; i<groupedQueries.size(); i++) {
+        prepareSharedBall(groupedQueries, i);
+        answerQuery(groupedQueries[i].source, groupedQueries[i].target, groupedQueries[i].k, answers[order[i]]);
+    }
+    sharedBall = NULL;
+}
+
+
+
+// start a ball for the run of queries from i with the same source or target, unless the current ball covers query i
+void EVE::prepareSharedBall(vector<PerQuery>& queries, size_t i) {
+    PerQuery& query = queries[i];
+    if (sharedBall && sharedBall->covers(query.source, query.target))
+        return;
+    sharedBall = NULL;
+
+    // runs of queries with the same source or target
+    size_t sourceRunEnd = i+1, targetRunEnd = i+1;
+    for (; sourceRunEnd<queries.size() && queries[sourceRunEnd].source==query.source; sourceRunEnd++);
+    for (; targetRunEnd<queries.size() && queries[targetRunEnd].target==query.target; targetRunEnd++);
+
+    // share the ball of the longer run, whose levels are built when BFS of queries needs them
+    if (sourceRunEnd-i<2 && targetRunEnd-i<2)
+        return;
+    if (ball==NULL)
+        ball = new HopBall(graph);
+    if (sourceRunEnd>=targetRunEnd)
+        ball->reset(query.source, true);
+    else
+        ball->reset(query.target, false);
+    sharedBall = ball;
+}
+
+
+
 // execute for each query
 EdgeID EVE::executeQuery(VertexID source, VertexID target, short k) {
 
+    // arrays of graph are moved by updates, memory is only sized again if |E| grows
+    if (layoutVersion!=graph->layoutVersion) {
+        if (graph->EN==EN) {
+            loadGraph();
+            if (kMax>4)
+                verification->loadGraph();
+        } else {
+            cleanUp();
+            loadGraph();
+            initEVE();
+        }
+    }
+
+    // no path if the index bounds d(s,t) above k, skipping all phases
+    if (landmarkIndex && landmarkIndex->getDistLowerBound(source, target)>k) {
+        resultEnd = definiteEnd = 0;
+        #ifdef WRITE_STATISTICS
+            upperboundCount = 0;
+            isAnsweredWithoutPhases = true;
+        #endif
+        memset(phaseTimes, 0, sizeof(phaseTimes));
+        if (trace) {
+            trace->reset(graph->getOriginalId(source), graph->getOriginalId(target), k);
+            trace->rejectedByIndex = true;
+        }
+        return 0;
+    }
+
     // initialization
     s = source;
     t = target;
+    maxLen = k;
+    specialize<minSpecializedK>(k);
     refreshMemory();
+    if (trace) {
+        trace->reset(graph->getOriginalId(s), graph->getOriginalId(t), k);
+        if (kMax>4)
+            verification->trace = trace;
+    }
+    double phaseStartTime = (recordPhaseTimes || trace) ? getPreciseTimeInMs() : 0;
+
+    // no path if the other end is not reachable from (or to) the center of a complete shared ball
+    queryBall = (sharedBall && sharedBall->covers(s, t)) ? sharedBall : NULL;
+    if (queryBall && queryBall->isComplete && s!=t && queryBall->getDist(queryBall->isForward ? t : s)>k) {
+        definiteEnd = 0;
+        for (int phase=0; phase<EVEPhaseNumber; phase++)
+            finishPhase((EVEPhase)phase, phaseStartTime);
+        return 0;
+    }
 
     // adaptive bi-directional BFS
     adaptiveBiDirectBFS();
+    finishPhase(BFSPhase, phaseStartTime);
     
     // forward and backward propagation to obtain essential vertices
     if (startPropDirection) {
-        forwardPropagation();
-        backwardPropagation();
+        (this->*specialization.forwardPropagation)();
+        (this->*specialization.backwardPropagation)();
     } else {
-        backwardPropagation();
-        forwardPropagation();
+        (this->*specialization.backwardPropagation)();
+        (this->*specialization.forwardPropagation)();
+    }
+    finishPhase(propagationPhase, phaseStartTime);
+
+    // many candidates are labeled by threads first, as labeling only reads essential vertices
+    bool isLabeledInParallel = intraQueryThreads>1 && candidateEnd>=parallelCandidateNumber;
+    if (isLabeledInParallel) {
+        candidateLabels.resize(candidateEnd);
+        parallelForChunks(candidateEnd, intraQueryThreads, parallelChunkSize, [this](int threadId, size_t begin, size_t end) {
+            for (size_t i=begin; i<end; i++)
+                candidateLabels[i] = (this->*specialization.edgeLabeling)(candidates[i]);
+        });
     }
 
-    // iterate each candidate edge for edge labeling
+    // iterate each candidate edge for edge labeling, in order of candidates
     for (EdgeID i=0; i<candidateEnd; i++) {
         EdgeID& edgeId = candidates[i];
         VertexID& u = edges[edgeId].fromId;
         VertexID& v = edges[edgeId].toId;
 
         // edge labeling
-        short label = edgeLabeling(edgeId);
+        short label = isLabeledInParallel ? candidateLabels[i] : (this->*specialization.edgeLabeling)(edgeId);
+        if (label&(InDBit|OutABit)) {
+            addToInDOutA(u, v, label);
+            label &= ~(InDBit|OutABit);
+        }
 
         // definite edges
         if (label==2) {
             results[resultEnd] = edgeId;
             resultEnd++;
-            if (maxLen>4 && u!=s && v!=t) {
+            if (maxLen>4 && u!=s && v!=t && !isUpperboundAnswer) {
                 isInResult[edgeId] = offset;
                 addToPrunedNeighbors(u, v, edgeId);
             }
 
         // undetermined edges
         } else if (label==1 && maxLen>4) {
-            addToPrunedNeighbors(u, v, edgeId);
+            if (!isUpperboundAnswer)
+                addToPrunedNeighbors(u, v, edgeId);
             edgesForVerification[edgesForVerificationEnd] = edgeId;
             edgesForVerificationEnd++;
         }
@@ -129,56 +401,106 @@ EdgeID EVE::executeQuery(VertexID source, VertexID target, short k) {
         // statistics
         #ifdef WRITE_STATISTICS
             if (label>0)
-                numOfUpperbound[queryId]++;
+                upperboundCount++;
         #endif
+        if (trace) {
+            if (label==2)
+                trace->definiteEdges++;
+            else if (label==1)
+                trace->undeterminedEdges++;
+        }
     }
-
-    // verify each edge
-    if (maxLen>4) 
-        resultEnd = verification->verifyUndeterminedEdge(resultEnd, edgesForVerificationEnd, verticesHavingOutNeighborsEnd, verticesHavingInNeighborsEnd, departuresEnd, arrivalsEnd);
+    if (trace)
+        trace->candidateEdges = candidateEnd;
+
+    finishPhase(labelingPhase, phaseStartTime);
+
+    // verify each edge, or answer undetermined edges after definite edges without verification
+    definiteEnd = resultEnd;
+    if (maxLen>4 && isUpperboundAnswer) {
+        memcpy(results+resultEnd, edgesForVerification, sizeof(EdgeID)*edgesForVerificationEnd);
+        resultEnd += edgesForVerificationEnd;
+    } else if (maxLen>4) {
+        verification->intraQueryThreads = intraQueryThreads;
+        resultEnd = verification->verifyUndeterminedEdge(offset, maxLen, resultEnd, edgesForVerificationEnd, verticesHavingOutNeighborsEnd, verticesHavingInNeighborsEnd, departuresEnd, arrivalsEnd);
+        definiteEnd = resultEnd;
+    }
+    finishPhase(verificationPhase, phaseStartTime);
     
     // statistics
     #ifdef WRITE_STATISTICS
-        numOfUpperbound[queryId] += specialCnt;
-        numOfAnswers[queryId] = resultEnd; 
-        spaceCosts[queryId] = getCurrentSpaceCost();
+        upperboundCount += specialCnt;
     #endif
+    if (trace)
+        trace->answerEdges = resultEnd;
 
     return resultEnd;
 }
 
 
 
+// phases specialized for k if minSpecializedK<=k<=maxSpecializedK, otherwise the generic ones (K=0)
+template<short K> void EVE::specialize(short k) {
+    if (K==0 || k==K) {
+        specialization.forwardPropagation = &EVE::forwardPropagation<K>;
+        specialization.backwardPropagation = &EVE::backwardPropagation<K>;
+        specialization.edgeLabeling = &EVE::edgeLabeling<K>;
+        return;
+    }
+    specialize<(K==0 || K>=maxSpecializedK ? 0 : K+1)>(k);
+}
+
+
+
+// record time of a phase if needed, and start next phase
+inline void EVE::finishPhase(EVEPhase phase, double& phaseStartTime) {
+    if (recordPhaseTimes || trace) {
+        double currentTime = getPreciseTimeInMs();
+        phaseTimes[phase] = currentTime-phaseStartTime;
+        phaseStartTime = currentTime;
+        if (trace)
+            trace->phaseTimes[phase] = phaseTimes[phase];
+    }
+}
+
+
+
 // initialization
 void EVE::initEVE() {
 
     // propagation for essential vertices
+    offset = 0;
+    maxLen = kMax;
+    isUpperboundAnswer = answerType=="upperbound";
+    definiteEnd = 0;
+    #ifdef WRITE_STATISTICS
+        isAnsweredWithoutPhases = false;
+    #endif
+    ball = sharedBall = queryBall = NULL;
     nextFrontier = new VertexID[VN];
+    vertexLocks = NULL;
+    frontierBitmap = new unsigned long long[VN/64+1]();
     forwardFrontier = new VertexID[VN];
     backwardFrontier = new VertexID[VN];
-    forwardDist = new int[VN]();
-    backwardDist = new int[VN]();
+    forwardDist = new Epoch[VN]();
+    backwardDist = new Epoch[VN]();
 
     // propagation for essential vertices
-    if (maxLen>2) {
-        forwardEV0 = new VertexID[(maxLen-2)*VN*(maxLen-2)];
-        backwardEV0 = new VertexID[(maxLen-2)*VN*(maxLen-2)];
-        forwardEVLen0 = new int[VN*(maxLen-2)]();
-        backwardEVLen0 = new int[VN*(maxLen-2)]();
-        forwardLastLocation = new int[VN]();
-        backwardLastLocation = new int[VN]();
-        lastEV = new VertexID[VN*(maxLen-2)];
-        lastEVEnds = new int[VN];
+    if (kMax>2) {
+        forwardEVStore = new EVStore(VN, kMax-2);
+        backwardEVStore = new EVStore(VN, kMax-2);
+        forwardLastLocation = new Epoch[VN]();
+        backwardLastLocation = new Epoch[VN]();
     }
     
     // edges in results
     results = new EdgeID[EN+1];
     candidates = results+1;
-    isInResult = new int[EN]();
+    isInResult = new Epoch[EN]();
 
     // for verify each edge
-    if (maxLen>4) {
-        verification = new Verification(graph, results, isInResult);
+    if (kMax>4) {
+        verification = new Verification(graph, results, isInResult, forwardDist, backwardDist, forwardFrontier, nextFrontier);
         prunedOutNeighbors = verification->prunedOutNeighbors;
         prunedInNeighbors = verification->prunedInNeighbors;
         prunedOutNeighborsEnd = verification->prunedOutNeighborsEnd;
@@ -189,10 +511,14 @@ void EVE::initEVE() {
         arrivals = verification->arrivals;
         InD = verification->InD;
         OutA = verification->OutA;
+        InDEnds = verification->InDEnds;
+        OutAEnds = verification->OutAEnds;
+        isDeparture = verification->isDeparture;
+        isArrival = verification->isArrival;
         edgesForVerification = verification->edgesForVerification;
 
         // for search ordering strategy
-        if (maxLen>6) {
+        if (kMax>6) {
             verticesHavingInNeighbors = verification->verticesHavingInNeighbors;
             verticesHavingOutNeighbors = verification->verticesHavingOutNeighbors;
         }   
@@ -204,22 +530,28 @@ void EVE::initEVE() {
 // refresh memory for new query
 inline void EVE::refreshMemory() {
 
-    // refresh offset
-    if (offset>=INT_MAX-maxLen-1) {
+    // refresh offset, leaving room for stamps of any query up to kMax
+    if (offset>=maxEpoch-kMax-1) {
         offset = 0;
-        if (maxLen>2) {
-            memset(forwardEVLen0, 0, sizeof(int)*VN*(maxLen-2));
-            memset(backwardEVLen0, 0, sizeof(int)*VN*(maxLen-2));
-            memset(forwardLastLocation, 0, sizeof(int)*VN);
-            memset(backwardLastLocation, 0, sizeof(int)*VN);
+        memset(forwardDist, 0, sizeof(Epoch)*VN);
+        memset(backwardDist, 0, sizeof(Epoch)*VN);
+        if (kMax>2) {
+            forwardEVStore->reset();
+            backwardEVStore->reset();
+            memset(forwardLastLocation, 0, sizeof(Epoch)*VN);
+            memset(backwardLastLocation, 0, sizeof(Epoch)*VN);
         }
-        memset(isInResult, 0, sizeof(int)*EN);
-        if (maxLen>4) 
+        memset(isInResult, 0, sizeof(Epoch)*EN);
+        if (kMax>4) 
             verification->refreshMemory();
     } 
-    offset += maxLen+1;
+    offset += kMax+1;
 
     // refresh storages
+    if (kMax>2) {
+        forwardEVStore->refresh(offset);
+        backwardEVStore->refresh(offset);
+    }
     candidateEnd = resultEnd = edgesForVerificationEnd = 0;
     departuresEnd = 0;
     arrivalsEnd = 0;
@@ -240,6 +572,8 @@ inline void EVE::refreshMemory() {
         forwardEVCount = 0;
         backwardEVCount = 0;
         specialCnt = 0;
+        upperboundCount = 0;
+        isAnsweredWithoutPhases = false;
     #endif
 }
 
@@ -250,21 +584,21 @@ void EVE::cleanUp() {
 
     // propagation for essential vertices
     delete[] nextFrontier;
+    delete[] vertexLocks;
+    delete[] frontierBitmap;
     delete[] forwardFrontier;
     delete[] backwardFrontier;
     delete[] forwardDist;
     delete[] backwardDist;
 
     // propagation for essential vertices
-    if (maxLen>2) {
-        delete[] forwardEV0;
-        delete[] backwardEV0;
-        delete[] forwardEVLen0;
-        delete[] backwardEVLen0;
+    if (kMax>2) {
+        forwardEVStore->cleanUp();
+        backwardEVStore->cleanUp();
+        delete forwardEVStore;
+        delete backwardEVStore;
         delete[] forwardLastLocation;
         delete[] backwardLastLocation;
-        delete[] lastEV;
-        delete[] lastEVEnds;
     }
     
     // results
@@ -272,8 +606,16 @@ void EVE::cleanUp() {
     delete[] results;
 
     // for verifying undetermined edges
-    if (maxLen>4) 
+    if (kMax>4) {
         verification->cleanUp();
+        delete verification;
+    }
+
+    // shared BFS ball
+    if (ball!=NULL) {
+        ball->cleanUp();
+        delete ball;
+    }
 }
 
 
@@ -324,6 +666,16 @@ inline void EVE::addToFinalCandidates(EdgeID& edgeId) {
 
 
 
+// add edge id to candidates by threads, each edge is added by only one thread in a hop
+inline void EVE::addToFinalCandidatesConcurrently(EdgeID& edgeId) {
+    if (isInResult[edgeId]<offset-1) {
+        isInResult[edgeId] = offset-1;
+        candidates[__sync_fetch_and_add(&candidateEnd, 1)] = edgeId;
+    }
+}
+
+
+
 // add a vertex u to essential vertices set
 inline void EVE::addToEV(VertexID u, VertexID* EVStart, int EVLen) {
     int i = EVLen;
@@ -348,62 +700,97 @@ void EVE::adaptiveBiDirectBFS() {
     backwardFrontier[0] = t;
     forwardFrontierEnd = 1;
     backwardFrontierEnd = 1;
+    forwardFrontierVolume = outNeighborsLocatorEnd[s]-outNeighborsLocator[s];
+    backwardFrontierVolume = inNeighborsLocatorEnd[t]-inNeighborsLocator[t];
     short backwardMaxHop=0, forwardMaxHop=0;
     
-    // explore one side until total length reaches maxLen
+    // explore the side with fewer edges to expand until total length reaches maxLen
     while (backwardMaxHop+forwardMaxHop<maxLen) {
         nextFrontierEnd = 0;
+        nextFrontierVolume = 0;
 
         // expand forward frontier
-        if (forwardFrontierEnd<backwardFrontierEnd) {
+        if (forwardFrontierVolume<backwardFrontierVolume) {
             forwardMaxHop++;
 
             // not the last step
-            if (backwardMaxHop+forwardMaxHop<maxLen) 
-                for (VertexID i=0; i<forwardFrontierEnd; i++) {
-                    VertexID& u = forwardFrontier[i];
-
-                    // iterate each edge u->v
-                    for (EdgeID edgeLocator=outNeighborsLocator[u]; edgeLocator<outNeighborsLocator[u+1]; edgeLocator++) {
-                        VertexID& v = outNeighbors[edgeLocator].neighbor;
-
-                        // update d(s,v) and push to next frontier
-                        if (forwardDist[v]<offset) {
+            if (backwardMaxHop+forwardMaxHop<maxLen) {
+                if (queryBall && queryBall->isForward)
+                    queryBall->extendTo(forwardMaxHop);
+
+                // levels of shared ball within d(s,t) hops are the same as BFS avoiding t
+                if (queryBall && queryBall->isForward && forwardMaxHop<=queryBall->getDist(t))
+                    for (VertexID i=queryBall->levelEnd[forwardMaxHop-1]; i<queryBall->levelEnd[forwardMaxHop]; i++) {
+                        VertexID& v = queryBall->vertices[i];
+                        if (v!=t) {
                             forwardDist[v] = offset+forwardMaxHop;
                             forwardMinId = min(forwardMinId, v);
                             forwardMaxId = max(forwardMaxId, v);
                             nextFrontier[nextFrontierEnd] = v;
                             nextFrontierEnd++;
+                            nextFrontierVolume += outNeighborsLocatorEnd[v]-outNeighborsLocator[v];
                         }
                     }
-                }
 
-            // is the last step
-            else {
-                continueDirection = true;
-                for (VertexID i=0; i<forwardFrontierEnd; i++) {
-                    VertexID& u = forwardFrontier[i];
-
-                    // iterate each edge u->v
-                    PerNeighbor* outNeighborsStart = outNeighbors+outNeighborsLocator[u];
-                    PerNeighbor* outNeighborsEnd = outNeighbors+outNeighborsLocator[u+1];
-                    if (outNeighborsEnd>outNeighborsStart && outNeighborsStart->neighbor<backwardMinId)
-                        outNeighborsStart = lower_bound(outNeighborsStart, outNeighborsEnd, PerNeighbor(0, backwardMinId));
-                    if (outNeighborsEnd>outNeighborsStart && (outNeighborsEnd-1)->neighbor>backwardMaxId)
-                        outNeighborsEnd = upper_bound(outNeighborsStart, outNeighborsEnd, PerNeighbor(0, backwardMaxId));
-                    for (; outNeighborsStart<outNeighborsEnd; outNeighborsStart++) {
-                        VertexID& v = outNeighborsStart->neighbor;
-
-                        // update d(s,v) and push to next frontier
-                        if (forwardDist[v]<offset) {
-                            if (backwardDist[v]>offset) {
+                // frontier of many edges
+                else if (bottomUpBFS && forwardFrontierVolume>EN/bottomUpRatio)
+                    expandBottomUp(true, forwardMaxHop, false);
+                else if (intraQueryThreads>1 && forwardFrontierVolume>=parallelFrontierVolume)
+                    expandTopDownInParallel(true, forwardMaxHop, false);
+                else 
+                    for (VertexID i=0; i<forwardFrontierEnd; i++) {
+                        VertexID& u = forwardFrontier[i];
+
+                        // iterate each edge u->v
+                        for (EdgeID edgeLocator=outNeighborsLocator[u]; edgeLocator<outNeighborsLocatorEnd[u]; edgeLocator++) {
+                            VertexID& v = outNeighbors[edgeLocator];
+
+                            // update d(s,v) and push to next frontier
+                            if (forwardDist[v]<offset) {
                                 forwardDist[v] = offset+forwardMaxHop;
                                 forwardMinId = min(forwardMinId, v);
                                 forwardMaxId = max(forwardMaxId, v);
                                 nextFrontier[nextFrontierEnd] = v;
                                 nextFrontierEnd++;
-                            } else 
-                                forwardDist[v] = offset;
+                                nextFrontierVolume += outNeighborsLocatorEnd[v]-outNeighborsLocator[v];
+                            }
+                        }
+                    }
+            }
+
+            // is the last step
+            else {
+                continueDirection = true;
+                if (bottomUpBFS && forwardFrontierVolume>EN/bottomUpRatio)
+                    expandBottomUp(true, forwardMaxHop, true);
+                else if (intraQueryThreads>1 && forwardFrontierVolume>=parallelFrontierVolume)
+                    expandTopDownInParallel(true, forwardMaxHop, true);
+                else {
+                    for (VertexID i=0; i<forwardFrontierEnd; i++) {
+                        VertexID& u = forwardFrontier[i];
+
+                        // iterate each edge u->v
+                        VertexID* outNeighborsStart = outNeighbors+outNeighborsLocator[u];
+                        VertexID* outNeighborsEnd = outNeighbors+outNeighborsLocatorEnd[u];
+                        if (outNeighborsEnd>outNeighborsStart && *outNeighborsStart<backwardMinId)
+                            outNeighborsStart = lower_bound(outNeighborsStart, outNeighborsEnd, backwardMinId);
+                        if (outNeighborsEnd>outNeighborsStart && *(outNeighborsEnd-1)>backwardMaxId)
+                            outNeighborsEnd = upper_bound(outNeighborsStart, outNeighborsEnd, backwardMaxId);
+                        for (; outNeighborsStart<outNeighborsEnd; outNeighborsStart++) {
+                            VertexID& v = *outNeighborsStart;
+
+                            // update d(s,v) and push to next frontier
+                            if (forwardDist[v]<offset) {
+                                if (backwardDist[v]>offset) {
+                                    forwardDist[v] = offset+forwardMaxHop;
+                                    forwardMinId = min(forwardMinId, v);
+                                    forwardMaxId = max(forwardMaxId, v);
+                                    nextFrontier[nextFrontierEnd] = v;
+                                    nextFrontierEnd++;
+                                    nextFrontierVolume += outNeighborsLocatorEnd[v]-outNeighborsLocator[v];
+                                } else 
+                                    forwardDist[v] = offset;
+                            }
                         }
                     }
                 }
@@ -414,60 +801,95 @@ void EVE::adaptiveBiDirectBFS() {
             forwardFrontier = nextFrontier;
             nextFrontier = tmp;
             forwardFrontierEnd = nextFrontierEnd;
+            forwardFrontierVolume = nextFrontierVolume;
 
             // statistics
             #ifdef WRITE_STATISTICS
                 maxFrontierSize = max(forwardFrontierEnd, maxFrontierSize);
             #endif
+            if (trace)
+                trace->forwardFrontierSizes.push_back(forwardFrontierEnd);
 
         // expand backward frontier
         } else {
             backwardMaxHop++;
 
             // not the last step
-            if (forwardMaxHop+backwardMaxHop<maxLen) 
-                for (VertexID i=0; i<backwardFrontierEnd; i++) {
-                    VertexID& u = backwardFrontier[i];
-                    for (EdgeID edgeLocator=inNeighborsLocator[u]; edgeLocator<inNeighborsLocator[u+1]; edgeLocator++) {
-                        VertexID& v = inNeighbors[edgeLocator].neighbor;
-
-                        // update d(v,t) and push to next frontier
-                        if (backwardDist[v]<offset) {
+            if (forwardMaxHop+backwardMaxHop<maxLen) {
+                if (queryBall && !queryBall->isForward)
+                    queryBall->extendTo(backwardMaxHop);
+
+                // levels of shared ball within d(s,t) hops are the same as BFS avoiding s
+                if (queryBall && !queryBall->isForward && backwardMaxHop<=queryBall->getDist(s))
+                    for (VertexID i=queryBall->levelEnd[backwardMaxHop-1]; i<queryBall->levelEnd[backwardMaxHop]; i++) {
+                        VertexID& v = queryBall->vertices[i];
+                        if (v!=s) {
                             backwardDist[v] = offset+backwardMaxHop;
                             backwardMinId = min(backwardMinId, v);
                             backwardMaxId = max(backwardMaxId, v);
                             nextFrontier[nextFrontierEnd] = v;
                             nextFrontierEnd++;
+                            nextFrontierVolume += inNeighborsLocatorEnd[v]-inNeighborsLocator[v];
                         }
                     }
-                }
 
-            // is the last step
-            else {
-                continueDirection = false;
-                for (VertexID i=0; i<backwardFrontierEnd; i++) {
-                    VertexID& u = backwardFrontier[i];
-
-                    // iterate each in edge v->u
-                    PerNeighbor* inNeighborsStart = inNeighbors+inNeighborsLocator[u];
-                    PerNeighbor* inNeighborsEnd = inNeighbors+inNeighborsLocator[u+1];
-                    if (inNeighborsEnd>inNeighborsStart && inNeighborsStart->neighbor<forwardMinId)
-                        inNeighborsStart = lower_bound(inNeighborsStart, inNeighborsEnd, PerNeighbor(0, forwardMinId));
-                    if (inNeighborsEnd>inNeighborsStart && (inNeighborsEnd-1)->neighbor>forwardMaxId)
-                        inNeighborsEnd = upper_bound(inNeighborsStart, inNeighborsEnd, PerNeighbor(0, forwardMaxId));
-                    for (; inNeighborsStart<inNeighborsEnd; inNeighborsStart++) {
-                        VertexID& v = inNeighborsStart->neighbor;
-
-                        // update d(v,t) and push to next frontier
-                        if (backwardDist[v]<offset) {
-                            if (forwardDist[v]>offset) {
+                // frontier of many edges
+                else if (bottomUpBFS && backwardFrontierVolume>EN/bottomUpRatio)
+                    expandBottomUp(false, backwardMaxHop, false);
+                else if (intraQueryThreads>1 && backwardFrontierVolume>=parallelFrontierVolume)
+                    expandTopDownInParallel(false, backwardMaxHop, false);
+                else 
+                    for (VertexID i=0; i<backwardFrontierEnd; i++) {
+                        VertexID& u = backwardFrontier[i];
+                        for (EdgeID edgeLocator=inNeighborsLocator[u]; edgeLocator<inNeighborsLocatorEnd[u]; edgeLocator++) {
+                            VertexID& v = inNeighbors[edgeLocator];
+
+                            // update d(v,t) and push to next frontier
+                            if (backwardDist[v]<offset) {
                                 backwardDist[v] = offset+backwardMaxHop;
                                 backwardMinId = min(backwardMinId, v);
                                 backwardMaxId = max(backwardMaxId, v);
                                 nextFrontier[nextFrontierEnd] = v;
                                 nextFrontierEnd++;
-                            } else 
-                                backwardDist[v] = offset;
+                                nextFrontierVolume += inNeighborsLocatorEnd[v]-inNeighborsLocator[v];
+                            }
+                        }
+                    }
+            }
+
+            // is the last step
+            else {
+                continueDirection = false;
+                if (bottomUpBFS && backwardFrontierVolume>EN/bottomUpRatio)
+                    expandBottomUp(false, backwardMaxHop, true);
+                else if (intraQueryThreads>1 && backwardFrontierVolume>=parallelFrontierVolume)
+                    expandTopDownInParallel(false, backwardMaxHop, true);
+                else {
+                    for (VertexID i=0; i<backwardFrontierEnd; i++) {
+                        VertexID& u = backwardFrontier[i];
+
+                        // iterate each in edge v->u
+                        VertexID* inNeighborsStart = inNeighbors+inNeighborsLocator[u];
+                        VertexID* inNeighborsEnd = inNeighbors+inNeighborsLocatorEnd[u];
+                        if (inNeighborsEnd>inNeighborsStart && *inNeighborsStart<forwardMinId)
+                            inNeighborsStart = lower_bound(inNeighborsStart, inNeighborsEnd, forwardMinId);
+                        if (inNeighborsEnd>inNeighborsStart && *(inNeighborsEnd-1)>forwardMaxId)
+                            inNeighborsEnd = upper_bound(inNeighborsStart, inNeighborsEnd, forwardMaxId);
+                        for (; inNeighborsStart<inNeighborsEnd; inNeighborsStart++) {
+                            VertexID& v = *inNeighborsStart;
+
+                            // update d(v,t) and push to next frontier
+                            if (backwardDist[v]<offset) {
+                                if (forwardDist[v]>offset) {
+                                    backwardDist[v] = offset+backwardMaxHop;
+                                    backwardMinId = min(backwardMinId, v);
+                                    backwardMaxId = max(backwardMaxId, v);
+                                    nextFrontier[nextFrontierEnd] = v;
+                                    nextFrontierEnd++;
+                                    nextFrontierVolume += inNeighborsLocatorEnd[v]-inNeighborsLocator[v];
+                                } else 
+                                    backwardDist[v] = offset;
+                            }
                         }
                     }
                 }
@@ -478,11 +900,14 @@ void EVE::adaptiveBiDirectBFS() {
             backwardFrontier = nextFrontier;
             nextFrontier = tmp;
             backwardFrontierEnd = nextFrontierEnd;
+            backwardFrontierVolume = nextFrontierVolume;
 
             // statistics
             #ifdef WRITE_STATISTICS
                 maxFrontierSize = max(backwardFrontierEnd, maxFrontierSize);
             #endif
+            if (trace)
+                trace->backwardFrontierSizes.push_back(backwardFrontierEnd);
         }
     }
 
@@ -490,41 +915,53 @@ void EVE::adaptiveBiDirectBFS() {
     if (continueDirection) {
         for (short k=forwardMaxHop+1; k<=maxLen-1; k++) {
             nextFrontierEnd = 0;
+            nextFrontierVolume = 0;
 
             // each u in current frontier
-            for (VertexID i=0; i<forwardFrontierEnd; i++) {
-                VertexID& u = forwardFrontier[i];
+            if (bottomUpBFS && forwardFrontierVolume>EN/bottomUpRatio)
+                expandBottomUp(true, k, true);
+            else if (intraQueryThreads>1 && forwardFrontierVolume>=parallelFrontierVolume)
+                expandTopDownInParallel(true, k, true);
+            else {
+                for (VertexID i=0; i<forwardFrontierEnd; i++) {
+                    VertexID& u = forwardFrontier[i];
                 
-                // iterate each out edge u->v
-                PerNeighbor* outNeighborsStart = outNeighbors+outNeighborsLocator[u];
-                PerNeighbor* outNeighborsEnd = outNeighbors+outNeighborsLocator[u+1];
-                if (outNeighborsEnd>outNeighborsStart && outNeighborsStart->neighbor<backwardMinId)
-                    outNeighborsStart = lower_bound(outNeighborsStart, outNeighborsEnd, PerNeighbor(0, backwardMinId));
-                if (outNeighborsEnd>outNeighborsStart && (outNeighborsEnd-1)->neighbor>backwardMaxId)
-                    outNeighborsEnd = upper_bound(outNeighborsStart, outNeighborsEnd, PerNeighbor(0, backwardMaxId));
-                for (; outNeighborsStart<outNeighborsEnd; outNeighborsStart++) {
-                    VertexID& v = outNeighborsStart->neighbor;
-                    if (forwardDist[v]<offset) {
+                    // iterate each out edge u->v
+                    VertexID* outNeighborsStart = outNeighbors+outNeighborsLocator[u];
+                    VertexID* outNeighborsEnd = outNeighbors+outNeighborsLocatorEnd[u];
+                    if (outNeighborsEnd>outNeighborsStart && *outNeighborsStart<backwardMinId)
+                        outNeighborsStart = lower_bound(outNeighborsStart, outNeighborsEnd, backwardMinId);
+                    if (outNeighborsEnd>outNeighborsStart && *(outNeighborsEnd-1)>backwardMaxId)
+                        outNeighborsEnd = upper_bound(outNeighborsStart, outNeighborsEnd, backwardMaxId);
+                    for (; outNeighborsStart<outNeighborsEnd; outNeighborsStart++) {
+                        VertexID& v = *outNeighborsStart;
+                        if (forwardDist[v]<offset) {
 
-                        // update d(s,v) and push to next frontier
-                        if ( backwardDist[v]>offset && k+backwardDist[v]-offset<=maxLen )  {
-                            forwardDist[v] = offset+k;
-                            forwardMinId = min(forwardMinId, v);
-                            forwardMaxId = max(forwardMaxId, v);
-                            nextFrontier[nextFrontierEnd] = v;
-                            nextFrontierEnd++;
-                        } else 
-                            forwardDist[v] = offset;
+                            // update d(s,v) and push to next frontier
+                            if ( backwardDist[v]>offset && k+backwardDist[v]-offset<=maxLen )  {
+                                forwardDist[v] = offset+k;
+                                forwardMinId = min(forwardMinId, v);
+                                forwardMaxId = max(forwardMaxId, v);
+                                nextFrontier[nextFrontierEnd] = v;
+                                nextFrontierEnd++;
+                                nextFrontierVolume += outNeighborsLocatorEnd[v]-outNeighborsLocator[v];
+                            } else 
+                                forwardDist[v] = offset;
+                        }
                     }
                 }
             }
 
+            if (trace)
+                trace->forwardFrontierSizes.push_back(nextFrontierEnd);
+
             // swap frontier
             if (k<maxLen-1) {
                 VertexID* tmp = forwardFrontier;
                 forwardFrontier = nextFrontier;
                 nextFrontier = tmp;
                 forwardFrontierEnd = nextFrontierEnd;
+                forwardFrontierVolume = nextFrontierVolume;
 
                 // statistics
                 #ifdef WRITE_STATISTICS
@@ -538,41 +975,53 @@ void EVE::adaptiveBiDirectBFS() {
     } else {
         for (short k=backwardMaxHop+1; k<=maxLen-1; k++) {
             nextFrontierEnd = 0;
+            nextFrontierVolume = 0;
 
             // each u in current frontier
-            for (VertexID i=0; i<backwardFrontierEnd; i++) {
-                VertexID& u = backwardFrontier[i];
+            if (bottomUpBFS && backwardFrontierVolume>EN/bottomUpRatio)
+                expandBottomUp(false, k, true);
+            else if (intraQueryThreads>1 && backwardFrontierVolume>=parallelFrontierVolume)
+                expandTopDownInParallel(false, k, true);
+            else {
+                for (VertexID i=0; i<backwardFrontierEnd; i++) {
+                    VertexID& u = backwardFrontier[i];
                 
-                // each in edge v->u
-                PerNeighbor* inNeighborsStart = inNeighbors+inNeighborsLocator[u];
-                PerNeighbor* inNeighborsEnd = inNeighbors+inNeighborsLocator[u+1];
-                if (inNeighborsEnd>inNeighborsStart && inNeighborsStart->neighbor<forwardMinId)
-                    inNeighborsStart = lower_bound(inNeighborsStart, inNeighborsEnd, PerNeighbor(0, forwardMinId));
-                if (inNeighborsEnd>inNeighborsStart && (inNeighborsEnd-1)->neighbor>forwardMaxId)
-                    inNeighborsEnd = upper_bound(inNeighborsStart, inNeighborsEnd, PerNeighbor(0, forwardMaxId));
-                for (; inNeighborsStart<inNeighborsEnd; inNeighborsStart++) {
-                    VertexID& v = inNeighborsStart->neighbor;
-
-                    // update d(v,t) and push to next frontier
-                    if (backwardDist[v]<offset) {
-                        if ( forwardDist[v]>offset && k+forwardDist[v]-offset<=maxLen )  {
-                            backwardDist[v] = offset+k;
-                            backwardMinId = min(backwardMinId, v);
-                            backwardMaxId = max(backwardMaxId, v);
-                            nextFrontier[nextFrontierEnd] = v;
-                            nextFrontierEnd++;
-                        } else 
-                            backwardDist[v] = offset;
+                    // each in edge v->u
+                    VertexID* inNeighborsStart = inNeighbors+inNeighborsLocator[u];
+                    VertexID* inNeighborsEnd = inNeighbors+inNeighborsLocatorEnd[u];
+                    if (inNeighborsEnd>inNeighborsStart && *inNeighborsStart<forwardMinId)
+                        inNeighborsStart = lower_bound(inNeighborsStart, inNeighborsEnd, forwardMinId);
+                    if (inNeighborsEnd>inNeighborsStart && *(inNeighborsEnd-1)>forwardMaxId)
+                        inNeighborsEnd = upper_bound(inNeighborsStart, inNeighborsEnd, forwardMaxId);
+                    for (; inNeighborsStart<inNeighborsEnd; inNeighborsStart++) {
+                        VertexID& v = *inNeighborsStart;
+
+                        // update d(v,t) and push to next frontier
+                        if (backwardDist[v]<offset) {
+                            if ( forwardDist[v]>offset && k+forwardDist[v]-offset<=maxLen )  {
+                                backwardDist[v] = offset+k;
+                                backwardMinId = min(backwardMinId, v);
+                                backwardMaxId = max(backwardMaxId, v);
+                                nextFrontier[nextFrontierEnd] = v;
+                                nextFrontierEnd++;
+                                nextFrontierVolume += inNeighborsLocatorEnd[v]-inNeighborsLocator[v];
+                            } else 
+                                backwardDist[v] = offset;
+                        }
                     }
                 }
             }
 
+            if (trace)
+                trace->backwardFrontierSizes.push_back(nextFrontierEnd);
+
             // swap frontier
             if (k<maxLen-1) {
                 VertexID* tmp = backwardFrontier;
                 backwardFrontier = nextFrontier;
                 nextFrontier = tmp;
                 backwardFrontierEnd = nextFrontierEnd;
+                backwardFrontierVolume = nextFrontierVolume;
 
                 // statistics
                 #ifdef WRITE_STATISTICS
@@ -586,25 +1035,137 @@ void EVE::adaptiveBiDirectBFS() {
 
 
 
+// expand a frontier bottom-up, each unvisited vertex looks for a neighbor in the frontier by edges of the other direction
+// if meeting the other side, only vertices visited by the other side within maxLen are pushed, while the others in its id range are marked
+// the next frontier is the same as top-down, while each vertex stops at its first neighbor found
+void EVE::expandBottomUp(bool isForward, short hop, bool isMeeting) {
+    VertexID* frontier = isForward ? forwardFrontier : backwardFrontier;
+    VertexID frontierEnd = isForward ? forwardFrontierEnd : backwardFrontierEnd;
+    Epoch* dist = isForward ? forwardDist : backwardDist;
+    Epoch* otherDist = isForward ? backwardDist : forwardDist;
+    VertexID& minId = isForward ? forwardMinId : backwardMinId;
+    VertexID& maxId = isForward ? forwardMaxId : backwardMaxId;
+    VertexID rangeStart = isMeeting ? (isForward ? backwardMinId : forwardMinId) : 0;
+    VertexID rangeEnd = isMeeting ? (isForward ? backwardMaxId : forwardMaxId)+1 : VN;
+    EdgeID* locator = isForward ? inNeighborsLocator : outNeighborsLocator;
+    EdgeID* locatorEnd = isForward ? inNeighborsLocatorEnd : outNeighborsLocatorEnd;
+    VertexID* neighbors = isForward ? inNeighbors : outNeighbors;
+    EdgeID* nextLocator = isForward ? outNeighborsLocator : inNeighborsLocator;
+    EdgeID* nextLocatorEnd = isForward ? outNeighborsLocatorEnd : inNeighborsLocatorEnd;
+
+    // bitmap of frontier
+    for (VertexID i=0; i<frontierEnd; i++)
+        frontierBitmap[frontier[i]>>6] |= 1ULL<<(frontier[i]&63);
+
+    // each unvisited vertex v with an edge from (or to) frontier, chunks of vertices are scanned by threads of the query
+    vector<VertexID> minIds(intraQueryThreads, minId), maxIds(intraQueryThreads, maxId);
+    vector<EdgeID> volumes(intraQueryThreads, 0);
+    parallelForChunks(rangeEnd-rangeStart, intraQueryThreads, parallelChunkSize*64, [&](int threadId, size_t begin, size_t end) {
+        for (VertexID v=rangeStart+begin; v<rangeStart+end; v++)
+            if (dist[v]<offset)
+                for (EdgeID edgeLocator=locator[v]; edgeLocator<locatorEnd[v]; edgeLocator++) {
+                    VertexID& u = neighbors[edgeLocator];
+                    if (frontierBitmap[u>>6]&(1ULL<<(u&63))) {
+                        if (!isMeeting || (otherDist[v]>offset && hop+otherDist[v]-offset<=maxLen)) {
+                            dist[v] = offset+hop;
+                            minIds[threadId] = min(minIds[threadId], v);
+                            maxIds[threadId] = max(maxIds[threadId], v);
+                            nextFrontier[__sync_fetch_and_add(&nextFrontierEnd, 1)] = v;
+                            volumes[threadId] += nextLocatorEnd[v]-nextLocator[v];
+                        } else
+                            dist[v] = offset;
+                        break;
+                    }
+                }
+    });
+    for (int i=0; i<intraQueryThreads; i++) {
+        minId = min(minId, minIds[i]);
+        maxId = max(maxId, maxIds[i]);
+        nextFrontierVolume += volumes[i];
+    }
+
+    // clear bitmap for next use
+    for (VertexID i=0; i<frontierEnd; i++)
+        frontierBitmap[frontier[i]>>6] = 0;
+}
+
+
+
+// expand a frontier top-down by threads, each taking chunks of frontier and claiming unvisited vertices by compare-and-swap of distances
+// if meeting the other side, only vertices visited by the other side within maxLen are pushed, while the others are marked
+// the next frontier is the same as sequential expansion, in another order
+void EVE::expandTopDownInParallel(bool isForward, short hop, bool isMeeting) {
+    VertexID* frontier = isForward ? forwardFrontier : backwardFrontier;
+    VertexID frontierEnd = isForward ? forwardFrontierEnd : backwardFrontierEnd;
+    Epoch* dist = isForward ? forwardDist : backwardDist;
+    Epoch* otherDist = isForward ? backwardDist : forwardDist;
+    VertexID& minId = isForward ? forwardMinId : backwardMinId;
+    VertexID& maxId = isForward ? forwardMaxId : backwardMaxId;
+    VertexID otherMinId = isForward ? backwardMinId : forwardMinId;
+    VertexID otherMaxId = isForward ? backwardMaxId : forwardMaxId;
+    EdgeID* locator = isForward ? outNeighborsLocator : inNeighborsLocator;
+    EdgeID* locatorEnd = isForward ? outNeighborsLocatorEnd : inNeighborsLocatorEnd;
+    VertexID* neighbors = isForward ? outNeighbors : inNeighbors;
+
+    // each edge u->v (or v->u) from frontier
+    vector<VertexID> minIds(intraQueryThreads, minId), maxIds(intraQueryThreads, maxId);
+    vector<EdgeID> volumes(intraQueryThreads, 0);
+    parallelForChunks(frontierEnd, intraQueryThreads, parallelChunkSize, [&](int threadId, size_t begin, size_t end) {
+        for (size_t i=begin; i<end; i++) {
+            VertexID u = frontier[i];
+            VertexID* neighborsStart = neighbors+locator[u];
+            VertexID* neighborsEnd = neighbors+locatorEnd[u];
+            if (isMeeting) {
+                if (neighborsEnd>neighborsStart && *neighborsStart<otherMinId)
+                    neighborsStart = lower_bound(neighborsStart, neighborsEnd, otherMinId);
+                if (neighborsEnd>neighborsStart && *(neighborsEnd-1)>otherMaxId)
+                    neighborsEnd = upper_bound(neighborsStart, neighborsEnd, otherMaxId);
+            }
+            for (; neighborsStart<neighborsEnd; neighborsStart++) {
+                VertexID v = *neighborsStart;
+                Epoch vDist = __atomic_load_n(dist+v, __ATOMIC_RELAXED);
+                if (vDist>=offset)
+                    continue;
+
+                // update distance of v and push to next frontier, if no other thread claims v first
+                bool isPushed = !isMeeting || (otherDist[v]>offset && hop+otherDist[v]-offset<=maxLen);
+                if (__sync_bool_compare_and_swap(dist+v, vDist, isPushed ? offset+hop : offset) && isPushed) {
+                    minIds[threadId] = min(minIds[threadId], v);
+                    maxIds[threadId] = max(maxIds[threadId], v);
+                    nextFrontier[__sync_fetch_and_add(&nextFrontierEnd, 1)] = v;
+                    volumes[threadId] += locatorEnd[v]-locator[v];
+                }
+            }
+        }
+    });
+    for (int i=0; i<intraQueryThreads; i++) {
+        minId = min(minId, minIds[i]);
+        maxId = max(maxId, maxIds[i]);
+        nextFrontierVolume += volumes[i];
+    }
+}
+
+
+
 // forward propagation
-void EVE::forwardPropagation() {
+template<short K> void EVE::forwardPropagation() {
     
     // preparation for next frontier
     forwardFrontierEnd = 0;
 
     // iterate each out edge s->v
-    PerNeighbor* outNeighborsStart = outNeighbors+outNeighborsLocator[s];
-    PerNeighbor* outNeighborsEnd = outNeighbors+outNeighborsLocator[s+1];
-    if (outNeighborsEnd>outNeighborsStart && outNeighborsStart->neighbor<backwardMinId)
-        outNeighborsStart = lower_bound(outNeighborsStart, outNeighborsEnd, PerNeighbor(0, backwardMinId));
-    if (outNeighborsEnd>outNeighborsStart && (outNeighborsEnd-1)->neighbor>backwardMaxId)
-        outNeighborsEnd = upper_bound(outNeighborsStart, outNeighborsEnd, PerNeighbor(0, backwardMaxId));
+    VertexID* outNeighborsStart = outNeighbors+outNeighborsLocator[s];
+    VertexID* outNeighborsEnd = outNeighbors+outNeighborsLocatorEnd[s];
+    if (outNeighborsEnd>outNeighborsStart && *outNeighborsStart<backwardMinId)
+        outNeighborsStart = lower_bound(outNeighborsStart, outNeighborsEnd, backwardMinId);
+    if (outNeighborsEnd>outNeighborsStart && *(outNeighborsEnd-1)>backwardMaxId)
+        outNeighborsEnd = upper_bound(outNeighborsStart, outNeighborsEnd, backwardMaxId);
     for (; outNeighborsStart<outNeighborsEnd; outNeighborsStart++) {
-        VertexID& v = outNeighborsStart->neighbor;
-        EdgeID& edgeId = outNeighborsStart->edgeId;
+        VertexID& v = *outNeighborsStart;
+        EdgeID& edgeId = outNeighborEdgeIds[outNeighborsStart-outNeighbors];
 
         // satisfying d(v,t)+1<=maxLen
-        if (backwardDist[v]>offset && backwardDist[v]-offset+1<=maxLen) {
+        if (backwardDist[v]>offset && backwardDist[v]-offset+1<=getMaxLen<K>()) {
             forwardFrontier[forwardFrontierEnd] = v;
             forwardFrontierEnd++;
             addToFinalCandidates(edgeId);
@@ -617,17 +1178,21 @@ void EVE::forwardPropagation() {
             }
 
             // need to use essential vertices only when maxLen>3 
-            if (maxLen>3) {
-                forwardEV(1, v) = v;
+            if (getMaxLen<K>()>3) {
+                forwardEVStore->touch(v);
+                forwardEV(1, v) = forwardEVStore->allocate(1);
+                forwardEV(1, v)[0] = v;
                 forwardEVLen(1, v) = offset+1;
                 forwardLastLocation[v] = offset+1;
-                lastEV[v*(maxLen-2)] = v;
-                lastEVEnds[v] = 1;
+                forwardEVStore->lastEV(v)[0] = v;
+                forwardEVStore->lastEVEnd(v) = 1;
 
                 // statistics
                 #ifdef WRITE_STATISTICS
                     forwardEVCount++;
                 #endif
+                if (trace)
+                    trace->forwardEVSizes[1]++;
             }
 
         // special cases if edge e(s,t) exists when start forward propagation first
@@ -643,7 +1208,13 @@ void EVE::forwardPropagation() {
     }
 
     // from 2 hop to maxLen-2 hop
-    for (int k=2; k<=maxLen-2; k++) {
+    for (int k=2; k<=getMaxLen<K>()-2; k++) {
+
+        // large frontier by threads
+        if (intraQueryThreads>1 && forwardFrontierEnd>=parallelFrontierSize) {
+            propagateInParallel(true, k);
+            continue;
+        }
 
         // initialize next frontier end
         nextFrontierEnd = 0;
@@ -651,31 +1222,32 @@ void EVE::forwardPropagation() {
         // each u in current frontier
         for (VertexID i=0; i<forwardFrontierEnd; i++) {
             VertexID& u = forwardFrontier[i];
-            VertexID* uEVStart = &forwardEV(k-1, u);
+            VertexID* uEVStart = forwardEV(k-1, u);
             VertexID* uEVEnd = uEVStart + (forwardEVLen(k-1, u)-offset);         
 
             // iterate each out edge u->v
-            PerNeighbor* outNeighborsStart = outNeighbors+outNeighborsLocator[u];
-            PerNeighbor* outNeighborsEnd = outNeighbors+outNeighborsLocator[u+1];
-            if (outNeighborsEnd>outNeighborsStart && outNeighborsStart->neighbor<backwardMinId)
-                outNeighborsStart = lower_bound(outNeighborsStart, outNeighborsEnd, PerNeighbor(0, backwardMinId));
-            if (outNeighborsEnd>outNeighborsStart && (outNeighborsEnd-1)->neighbor>backwardMaxId)
-                outNeighborsEnd = upper_bound(outNeighborsStart, outNeighborsEnd, PerNeighbor(0, backwardMaxId));
+            VertexID* outNeighborsStart = outNeighbors+outNeighborsLocator[u];
+            VertexID* outNeighborsEnd = outNeighbors+outNeighborsLocatorEnd[u];
+            if (outNeighborsEnd>outNeighborsStart && *outNeighborsStart<backwardMinId)
+                outNeighborsStart = lower_bound(outNeighborsStart, outNeighborsEnd, backwardMinId);
+            if (outNeighborsEnd>outNeighborsStart && *(outNeighborsEnd-1)>backwardMaxId)
+                outNeighborsEnd = upper_bound(outNeighborsStart, outNeighborsEnd, backwardMaxId);
             for (; outNeighborsStart<outNeighborsEnd; outNeighborsStart++) {
-                VertexID& v = outNeighborsStart->neighbor;
-                EdgeID& edgeId = outNeighborsStart->edgeId;
+                VertexID& v = *outNeighborsStart;
+                EdgeID& edgeId = outNeighborEdgeIds[outNeighborsStart-outNeighbors];
 
                 // satisfying k + d(v,t) <= maxLen
-                if (backwardDist[v]>offset && backwardDist[v]-offset+k<=maxLen) {
+                if (backwardDist[v]>offset && backwardDist[v]-offset+k<=getMaxLen<K>()) {
 
                     // if start forward propagation first, add to candidate edges
                     if (startPropDirection)
                         addToFinalCandidates(edgeId);
 
                     // essential set end of v in k step
-                    VertexID* lastEVStart = lastEV + v*(maxLen-2);
-                    int& lastEVLen = lastEVEnds[v];
-                    int& vEVLenWithOffset = forwardEVLen(k, v);
+                    forwardEVStore->touch(v);
+                    VertexID* lastEVStart = forwardEVStore->lastEV(v);
+                    int& lastEVLen = forwardEVStore->lastEVEnd(v);
+                    Epoch& vEVLenWithOffset = forwardEVLen(k, v);
 
                     // if v is not visited in k step
                     if (vEVLenWithOffset<offset) {
@@ -725,12 +1297,13 @@ void EVE::forwardPropagation() {
         forwardFrontierEnd = 0;
         for (VertexID i=0; i<nextFrontierEnd; i++) {
             VertexID& u = nextFrontier[i];
-            VertexID* uEVStart = &forwardEV(k, u);
-            VertexID* lastEVStart = lastEV + u*(maxLen-2);
-            int lastEVLen = lastEVEnds[u];
+            VertexID* lastEVStart = forwardEVStore->lastEV(u);
+            int lastEVLen = forwardEVStore->lastEVEnd(u);
             if ( forwardLastLocation[u]<offset || lastEVLen+1 < forwardEVLen(forwardLastLocation[u]-offset, u)-offset ) {
 
                 // copy from last essential vertices set to final essential vertices set
+                VertexID* uEVStart = forwardEVStore->allocate(lastEVLen+1);
+                forwardEV(k, u) = uEVStart;
                 memcpy(uEVStart, lastEVStart, lastEVLen*sizeof(VertexID));
                 
                 // add u to its essential vertices
@@ -742,6 +1315,8 @@ void EVE::forwardPropagation() {
                 #ifdef WRITE_STATISTICS
                     forwardEVCount += lastEVLen + 1;
                 #endif
+                if (trace)
+                    trace->forwardEVSizes[k] += lastEVLen + 1;
 
                 // add to next frontier
                 forwardFrontier[forwardFrontierEnd] = u;
@@ -752,26 +1327,28 @@ void EVE::forwardPropagation() {
     }
 
     // if start forward propagation first, continue for maxLen-1 hop
-    if (startPropDirection && maxLen>2)
+    if (startPropDirection && getMaxLen<K>()>2 && intraQueryThreads>1 && forwardFrontierEnd>=parallelFrontierSize)
+        propagateLastHopInParallel(true);
+    else if (startPropDirection && getMaxLen<K>()>2)
         for (VertexID i=0; i<forwardFrontierEnd; i++) {
             VertexID& u = forwardFrontier[i];       
 
             // iterate each out edge u->v
-            PerNeighbor* outNeighborsStart = outNeighbors+outNeighborsLocator[u];
-            PerNeighbor* outNeighborsEnd = outNeighbors+outNeighborsLocator[u+1];
-            if (outNeighborsEnd>outNeighborsStart && outNeighborsStart->neighbor<backwardMinId)
-                outNeighborsStart = lower_bound(outNeighborsStart, outNeighborsEnd, PerNeighbor(0, backwardMinId));
-            if (outNeighborsEnd>outNeighborsStart && (outNeighborsEnd-1)->neighbor>backwardMaxId)
-                outNeighborsEnd = upper_bound(outNeighborsStart, outNeighborsEnd, PerNeighbor(0, backwardMaxId));
+            VertexID* outNeighborsStart = outNeighbors+outNeighborsLocator[u];
+            VertexID* outNeighborsEnd = outNeighbors+outNeighborsLocatorEnd[u];
+            if (outNeighborsEnd>outNeighborsStart && *outNeighborsStart<backwardMinId)
+                outNeighborsStart = lower_bound(outNeighborsStart, outNeighborsEnd, backwardMinId);
+            if (outNeighborsEnd>outNeighborsStart && *(outNeighborsEnd-1)>backwardMaxId)
+                outNeighborsEnd = upper_bound(outNeighborsStart, outNeighborsEnd, backwardMaxId);
             for (; outNeighborsStart<outNeighborsEnd; outNeighborsStart++) {
-                VertexID& v = outNeighborsStart->neighbor;
-                EdgeID& edgeId = outNeighborsStart->edgeId;
+                VertexID& v = *outNeighborsStart;
+                EdgeID& edgeId = outNeighborEdgeIds[outNeighborsStart-outNeighbors];
 
                 // add to candidates, update d(s,v)
                 if (backwardDist[v]==offset+1) {
                     addToFinalCandidates(edgeId);
                     if (forwardDist[v]<offset) {
-                        forwardDist[v] = offset+maxLen-1;
+                        forwardDist[v] = offset+getMaxLen<K>()-1;
                         forwardMinId = min(forwardMinId, v);
                         forwardMaxId = max(forwardMaxId, v);
                     }
@@ -783,24 +1360,24 @@ void EVE::forwardPropagation() {
 
 
 // backward propagation
-void EVE::backwardPropagation() {
+template<short K> void EVE::backwardPropagation() {
     
     // initialization
     backwardFrontierEnd = 0;
 
     // iterate each in edge v->t
-    PerNeighbor* inNeighborsStart = inNeighbors+inNeighborsLocator[t];
-    PerNeighbor* inNeighborsEnd = inNeighbors+inNeighborsLocator[t+1];
-    if (inNeighborsEnd>inNeighborsStart && inNeighborsStart->neighbor<forwardMinId)
-        inNeighborsStart = lower_bound(inNeighborsStart, inNeighborsEnd, PerNeighbor(0, forwardMinId));
-    if (inNeighborsEnd>inNeighborsStart && (inNeighborsEnd-1)->neighbor>forwardMaxId)
-        inNeighborsEnd = upper_bound(inNeighborsStart, inNeighborsEnd, PerNeighbor(0, forwardMaxId));
+    VertexID* inNeighborsStart = inNeighbors+inNeighborsLocator[t];
+    VertexID* inNeighborsEnd = inNeighbors+inNeighborsLocatorEnd[t];
+    if (inNeighborsEnd>inNeighborsStart && *inNeighborsStart<forwardMinId)
+        inNeighborsStart = lower_bound(inNeighborsStart, inNeighborsEnd, forwardMinId);
+    if (inNeighborsEnd>inNeighborsStart && *(inNeighborsEnd-1)>forwardMaxId)
+        inNeighborsEnd = upper_bound(inNeighborsStart, inNeighborsEnd, forwardMaxId);
     for (; inNeighborsStart<inNeighborsEnd; inNeighborsStart++) {
-        EdgeID& edgeId = inNeighborsStart->edgeId;
-        VertexID& v = inNeighborsStart->neighbor;
+        EdgeID& edgeId = inNeighborEdgeIds[inNeighborsStart-inNeighbors];
+        VertexID& v = *inNeighborsStart;
 
         // satisfying d(s,v)+1<=maxLen
-        if (forwardDist[v]>offset && forwardDist[v]-offset+1<=maxLen) {
+        if (forwardDist[v]>offset && forwardDist[v]-offset+1<=getMaxLen<K>()) {
             backwardFrontier[backwardFrontierEnd] = v;
             backwardFrontierEnd++;
             addToFinalCandidates(edgeId);
@@ -813,17 +1390,21 @@ void EVE::backwardPropagation() {
             }
             
             // need to use essential vertices only when maxLen>3 
-            if (maxLen>3) {
-                backwardEV(1, v) = v;
+            if (getMaxLen<K>()>3) {
+                backwardEVStore->touch(v);
+                backwardEV(1, v) = backwardEVStore->allocate(1);
+                backwardEV(1, v)[0] = v;
                 backwardEVLen(1, v) = offset+1;
                 backwardLastLocation[v] = offset+1;
-                lastEV[v*(maxLen-2)] = v;
-                lastEVEnds[v] = 1;
+                backwardEVStore->lastEV(v)[0] = v;
+                backwardEVStore->lastEVEnd(v) = 1;
                 
                 // statistics
                 #ifdef WRITE_STATISTICS
                     backwardEVCount++;
                 #endif
+                if (trace)
+                    trace->backwardEVSizes[1]++;
             }
 
         // special cases if edge e(s,t) exists when start backward propagation first
@@ -839,7 +1420,13 @@ void EVE::backwardPropagation() {
     }
 
     // from 2 hop to maxLen-2 hop
-    for (int k=2; k<=maxLen-2; k++) {
+    for (int k=2; k<=getMaxLen<K>()-2; k++) {
+
+        // large frontier by threads
+        if (intraQueryThreads>1 && backwardFrontierEnd>=parallelFrontierSize) {
+            propagateInParallel(false, k);
+            continue;
+        }
 
         // initialize next frontier end
         nextFrontierEnd = 0;
@@ -847,31 +1434,32 @@ void EVE::backwardPropagation() {
         // each u in current frontier
         for (VertexID i=0; i<backwardFrontierEnd; i++) {
             VertexID& u = backwardFrontier[i];
-            VertexID* uEVStart = &backwardEV(k-1, u);
+            VertexID* uEVStart = backwardEV(k-1, u);
             VertexID* uEVEnd = uEVStart + (backwardEVLen(k-1, u)-offset);         
 
             // iterate each in edge v->u
-            PerNeighbor* inNeighborsStart = inNeighbors+inNeighborsLocator[u];
-            PerNeighbor* inNeighborsEnd = inNeighbors+inNeighborsLocator[u+1];
-            if (inNeighborsEnd>inNeighborsStart && inNeighborsStart->neighbor<forwardMinId)
-                inNeighborsStart = lower_bound(inNeighborsStart, inNeighborsEnd, PerNeighbor(0, forwardMinId));
-            if (inNeighborsEnd>inNeighborsStart && (inNeighborsEnd-1)->neighbor>forwardMaxId)
-                inNeighborsEnd = upper_bound(inNeighborsStart, inNeighborsEnd, PerNeighbor(0, forwardMaxId));
+            VertexID* inNeighborsStart = inNeighbors+inNeighborsLocator[u];
+            VertexID* inNeighborsEnd = inNeighbors+inNeighborsLocatorEnd[u];
+            if (inNeighborsEnd>inNeighborsStart && *inNeighborsStart<forwardMinId)
+                inNeighborsStart = lower_bound(inNeighborsStart, inNeighborsEnd, forwardMinId);
+            if (inNeighborsEnd>inNeighborsStart && *(inNeighborsEnd-1)>forwardMaxId)
+                inNeighborsEnd = upper_bound(inNeighborsStart, inNeighborsEnd, forwardMaxId);
             for (; inNeighborsStart<inNeighborsEnd; inNeighborsStart++) {
-                EdgeID& edgeId = inNeighborsStart->edgeId;
-                VertexID& v = inNeighborsStart->neighbor;
+                EdgeID& edgeId = inNeighborEdgeIds[inNeighborsStart-inNeighbors];
+                VertexID& v = *inNeighborsStart;
                 
                 // satisfying k + d(s,v) <= maxLen
-                if (forwardDist[v]>offset && forwardDist[v]-offset+k<=maxLen) {
+                if (forwardDist[v]>offset && forwardDist[v]-offset+k<=getMaxLen<K>()) {
 
                     // if start backward propagation first, add to candidate edges
                     if (!startPropDirection)
                         addToFinalCandidates(edgeId);
 
                     // essential set end of v in k step
-                    VertexID* lastEVStart = lastEV + v*(maxLen-2);
-                    int& lastEVLen = lastEVEnds[v];
-                    int& vEVLenWithOffset = backwardEVLen(k, v);
+                    backwardEVStore->touch(v);
+                    VertexID* lastEVStart = backwardEVStore->lastEV(v);
+                    int& lastEVLen = backwardEVStore->lastEVEnd(v);
+                    Epoch& vEVLenWithOffset = backwardEVLen(k, v);
 
                     // if v is not visited in k step
                     if (vEVLenWithOffset<offset) {
@@ -921,12 +1509,13 @@ void EVE::backwardPropagation() {
         backwardFrontierEnd = 0;
         for (VertexID i=0; i<nextFrontierEnd; i++) {   
             VertexID& u = nextFrontier[i];
-            VertexID* uEVStart = &backwardEV(k, u);
-            VertexID* lastEVStart = lastEV + u*(maxLen-2);
-            int lastEVLen = lastEVEnds[u];
+            VertexID* lastEVStart = backwardEVStore->lastEV(u);
+            int lastEVLen = backwardEVStore->lastEVEnd(u);
             if ( backwardLastLocation[u]<offset || lastEVLen+1 < backwardEVLen(backwardLastLocation[u]-offset, u)-offset ) {
 
                 // copy from last essential vertices set to final essential vertices set
+                VertexID* uEVStart = backwardEVStore->allocate(lastEVLen+1);
+                backwardEV(k, u) = uEVStart;
                 memcpy(uEVStart, lastEVStart, lastEVLen*sizeof(VertexID));
                 
                 // add u to its essential vertices
@@ -938,6 +1527,8 @@ void EVE::backwardPropagation() {
                 #ifdef WRITE_STATISTICS
                     backwardEVCount += lastEVLen + 1;
                 #endif
+                if (trace)
+                    trace->backwardEVSizes[k] += lastEVLen + 1;
 
                 // add to next frontier
                 backwardFrontier[backwardFrontierEnd] = u;
@@ -948,26 +1539,28 @@ void EVE::backwardPropagation() {
     }
 
     // if start backward propagation first, continue for maxLen-1 hop
-    if (!startPropDirection && maxLen>2)
+    if (!startPropDirection && getMaxLen<K>()>2 && intraQueryThreads>1 && backwardFrontierEnd>=parallelFrontierSize)
+        propagateLastHopInParallel(false);
+    else if (!startPropDirection && getMaxLen<K>()>2)
         for (VertexID i=0; i<backwardFrontierEnd; i++) {
             VertexID& u = backwardFrontier[i];       
 
             // iterate each in edge v->u
-            PerNeighbor* inNeighborsStart = inNeighbors+inNeighborsLocator[u];
-            PerNeighbor* inNeighborsEnd = inNeighbors+inNeighborsLocator[u+1];
-            if (inNeighborsEnd>inNeighborsStart && inNeighborsStart->neighbor<forwardMinId)
-                inNeighborsStart = lower_bound(inNeighborsStart, inNeighborsEnd, PerNeighbor(0, forwardMinId));
-            if (inNeighborsEnd>inNeighborsStart && (inNeighborsEnd-1)->neighbor>forwardMaxId)
-                inNeighborsEnd = upper_bound(inNeighborsStart, inNeighborsEnd, PerNeighbor(0, forwardMaxId));
+            VertexID* inNeighborsStart = inNeighbors+inNeighborsLocator[u];
+            VertexID* inNeighborsEnd = inNeighbors+inNeighborsLocatorEnd[u];
+            if (inNeighborsEnd>inNeighborsStart && *inNeighborsStart<forwardMinId)
+                inNeighborsStart = lower_bound(inNeighborsStart, inNeighborsEnd, forwardMinId);
+            if (inNeighborsEnd>inNeighborsStart && *(inNeighborsEnd-1)>forwardMaxId)
+                inNeighborsEnd = upper_bound(inNeighborsStart, inNeighborsEnd, forwardMaxId);
             for (; inNeighborsStart<inNeighborsEnd; inNeighborsStart++) {
-                VertexID& v = inNeighborsStart->neighbor;
-                EdgeID& edgeId = inNeighborsStart->edgeId;
+                VertexID& v = *inNeighborsStart;
+                EdgeID& edgeId = inNeighborEdgeIds[inNeighborsStart-inNeighbors];
 
                 // add to candidates, update d(v,t)
                 if (forwardDist[v]==offset+1) {
                     addToFinalCandidates(edgeId);
                     if (backwardDist[v]<offset) {
-                        backwardDist[v] = offset+maxLen-1;
+                        backwardDist[v] = offset+getMaxLen<K>()-1;
                         backwardMinId = min(backwardMinId, v);
                         backwardMaxId = max(backwardMaxId, v);
                     }
@@ -978,8 +1571,178 @@ void EVE::backwardPropagation() {
 
 
 
-// intersact for each candidate edge
-short EVE::edgeLabeling(EdgeID& edgeId) {
+// hop k of propagation by threads, the same as one hop of forwardPropagation() or backwardPropagation() but in another order of frontier
+// vertices of next frontier are updated under striped locks, and their essential vertices sets are allocated from arenas of threads
+void EVE::propagateInParallel(bool isForward, int k) {
+    EVStore* store = isForward ? forwardEVStore : backwardEVStore;
+    VertexID* frontier = isForward ? forwardFrontier : backwardFrontier;
+    VertexID& frontierEnd = isForward ? forwardFrontierEnd : backwardFrontierEnd;
+    Epoch* dist = isForward ? forwardDist : backwardDist;
+    Epoch* otherDist = isForward ? backwardDist : forwardDist;
+    Epoch* lastLocation = isForward ? forwardLastLocation : backwardLastLocation;
+    VertexID& minId = isForward ? forwardMinId : backwardMinId;
+    VertexID& maxId = isForward ? forwardMaxId : backwardMaxId;
+    VertexID otherMinId = isForward ? backwardMinId : forwardMinId;
+    VertexID otherMaxId = isForward ? backwardMaxId : forwardMaxId;
+    EdgeID* locator = isForward ? outNeighborsLocator : inNeighborsLocator;
+    EdgeID* locatorEnd = isForward ? outNeighborsLocatorEnd : inNeighborsLocatorEnd;
+    VertexID* neighbors = isForward ? outNeighbors : inNeighbors;
+    EdgeID* neighborEdgeIds = isForward ? outNeighborEdgeIds : inNeighborEdgeIds;
+    bool isFirstDirection = startPropDirection==isForward;
+
+    // slots and arenas are prepared before threads start, a slot for each vertex touched at most
+    if (vertexLocks==NULL)
+        vertexLocks = new mutex[vertexLockNumber];
+    EdgeID frontierVolume = 0;
+    for (VertexID i=0; i<frontierEnd; i++)
+        frontierVolume += locatorEnd[frontier[i]]-locator[frontier[i]];
+    store->reserve(min(frontierVolume, (EdgeID)VN));
+    store->setArenaNumber(intraQueryThreads);
+
+    // each edge u->v (or v->u) from current frontier
+    vector<VertexID> minIds(intraQueryThreads, minId), maxIds(intraQueryThreads, maxId);
+    nextFrontierEnd = 0;
+    parallelForChunks(frontierEnd, intraQueryThreads, parallelChunkSize, [&](int threadId, size_t begin, size_t end) {
+        for (size_t i=begin; i<end; i++) {
+            VertexID u = frontier[i];
+            VertexID* uEVStart = store->EV(k-1, u);
+            VertexID* uEVEnd = uEVStart + (store->EVLen(k-1, u)-offset);
+            VertexID* neighborsStart = neighbors+locator[u];
+            VertexID* neighborsEnd = neighbors+locatorEnd[u];
+            if (neighborsEnd>neighborsStart && *neighborsStart<otherMinId)
+                neighborsStart = lower_bound(neighborsStart, neighborsEnd, otherMinId);
+            if (neighborsEnd>neighborsStart && *(neighborsEnd-1)>otherMaxId)
+                neighborsEnd = upper_bound(neighborsStart, neighborsEnd, otherMaxId);
+            for (; neighborsStart<neighborsEnd; neighborsStart++) {
+                VertexID v = *neighborsStart;
+                EdgeID& edgeId = neighborEdgeIds[neighborsStart-neighbors];
+                if (otherDist[v]<=offset || otherDist[v]-offset+k>maxLen)
+                    continue;
+                if (isFirstDirection)
+                    addToFinalCandidatesConcurrently(edgeId);
+
+                // essential set end of v in k step
+                lock_guard<mutex> vertexLock(vertexLocks[v&(vertexLockNumber-1)]);
+                store->touchConcurrently(v);
+                VertexID* lastEVStart = store->lastEV(v);
+                int& lastEVLen = store->lastEVEnd(v);
+                Epoch& vEVLenWithOffset = store->EVLen(k, v);
+
+                // if v is not visited in k step, copy from u if last essential vertices set is not exists
+                if (vEVLenWithOffset<offset) {
+                    vEVLenWithOffset = offset;
+                    if (lastLocation[v]<offset) {
+                        if (isFirstDirection) {
+                            dist[v] = offset+k;
+                            minIds[threadId] = min(minIds[threadId], v);
+                            maxIds[threadId] = max(maxIds[threadId], v);
+                        }
+                        lastEVLen = uEVEnd-uEVStart;
+                        memcpy(lastEVStart, uEVStart, lastEVLen*sizeof(VertexID));
+                        nextFrontier[__sync_fetch_and_add(&nextFrontierEnd, 1)] = v;
+                    } else if (lastEVLen>0) {
+                        lastEVLen = set_intersection(lastEVStart, lastEVStart+lastEVLen, uEVStart, uEVEnd, lastEVStart) - lastEVStart;
+                        nextFrontier[__sync_fetch_and_add(&nextFrontierEnd, 1)] = v;
+                    }
+
+                // if v is visited in k step, do intersaction with last essential vertices set
+                } else if (lastEVLen>0)
+                    lastEVLen = set_intersection(lastEVStart, lastEVStart+lastEVLen, uEVStart, uEVEnd, lastEVStart) - lastEVStart;
+            }
+        }
+    });
+    for (int i=0; i<intraQueryThreads; i++) {
+        minId = min(minId, minIds[i]);
+        maxId = max(maxId, maxIds[i]);
+    }
+
+    // statistics
+    #ifdef WRITE_STATISTICS
+        maxFrontierSize = max(nextFrontierEnd, maxFrontierSize);
+    #endif
+
+    // for each u in next frontier, add u to its essential vertices
+    frontierEnd = 0;
+    parallelForChunks(nextFrontierEnd, intraQueryThreads, parallelChunkSize, [&](int threadId, size_t begin, size_t end) {
+        unsigned long long EVCount = 0;
+        for (size_t i=begin; i<end; i++) {
+            VertexID u = nextFrontier[i];
+            VertexID* lastEVStart = store->lastEV(u);
+            int lastEVLen = store->lastEVEnd(u);
+            if (lastLocation[u]<offset || lastEVLen+1 < store->EVLen(lastLocation[u]-offset, u)-offset) {
+                VertexID* uEVStart = store->allocate(lastEVLen+1, threadId);
+                store->EV(k, u) = uEVStart;
+                memcpy(uEVStart, lastEVStart, lastEVLen*sizeof(VertexID));
+                addToEV(u, uEVStart, lastEVLen);
+                store->EVLen(k, u) = offset + lastEVLen + 1;
+                lastLocation[u] = offset + k;
+                EVCount += lastEVLen + 1;
+                frontier[__sync_fetch_and_add(&frontierEnd, 1)] = u;
+            } else
+                store->EVLen(k, u) = 0;
+        }
+
+        // statistics
+        #ifdef WRITE_STATISTICS
+            __sync_fetch_and_add(isForward ? &forwardEVCount : &backwardEVCount, EVCount);
+        #endif
+        if (trace)
+            __sync_fetch_and_add(isForward ? &trace->forwardEVSizes[k] : &trace->backwardEVSizes[k], EVCount);
+    });
+}
+
+
+
+// hop maxLen-1 of the first propagation by threads, adding edges to t (or from s) to candidates
+void EVE::propagateLastHopInParallel(bool isForward) {
+    VertexID* frontier = isForward ? forwardFrontier : backwardFrontier;
+    VertexID frontierEnd = isForward ? forwardFrontierEnd : backwardFrontierEnd;
+    Epoch* dist = isForward ? forwardDist : backwardDist;
+    Epoch* otherDist = isForward ? backwardDist : forwardDist;
+    VertexID& minId = isForward ? forwardMinId : backwardMinId;
+    VertexID& maxId = isForward ? forwardMaxId : backwardMaxId;
+    VertexID otherMinId = isForward ? backwardMinId : forwardMinId;
+    VertexID otherMaxId = isForward ? backwardMaxId : forwardMaxId;
+    EdgeID* locator = isForward ? outNeighborsLocator : inNeighborsLocator;
+    EdgeID* locatorEnd = isForward ? outNeighborsLocatorEnd : inNeighborsLocatorEnd;
+    VertexID* neighbors = isForward ? outNeighbors : inNeighbors;
+    EdgeID* neighborEdgeIds = isForward ? outNeighborEdgeIds : inNeighborEdgeIds;
+
+    // each edge u->v (or v->u) from frontier, v is claimed by compare-and-swap of its distance
+    vector<VertexID> minIds(intraQueryThreads, minId), maxIds(intraQueryThreads, maxId);
+    parallelForChunks(frontierEnd, intraQueryThreads, parallelChunkSize, [&](int threadId, size_t begin, size_t end) {
+        for (size_t i=begin; i<end; i++) {
+            VertexID u = frontier[i];
+            VertexID* neighborsStart = neighbors+locator[u];
+            VertexID* neighborsEnd = neighbors+locatorEnd[u];
+            if (neighborsEnd>neighborsStart && *neighborsStart<otherMinId)
+                neighborsStart = lower_bound(neighborsStart, neighborsEnd, otherMinId);
+            if (neighborsEnd>neighborsStart && *(neighborsEnd-1)>otherMaxId)
+                neighborsEnd = upper_bound(neighborsStart, neighborsEnd, otherMaxId);
+            for (; neighborsStart<neighborsEnd; neighborsStart++) {
+                VertexID v = *neighborsStart;
+                if (otherDist[v]!=offset+1)
+                    continue;
+                addToFinalCandidatesConcurrently(neighborEdgeIds[neighborsStart-neighbors]);
+                Epoch vDist = __atomic_load_n(dist+v, __ATOMIC_RELAXED);
+                if (vDist<offset && __sync_bool_compare_and_swap(dist+v, vDist, offset+maxLen-1)) {
+                    minIds[threadId] = min(minIds[threadId], v);
+                    maxIds[threadId] = max(maxIds[threadId], v);
+                }
+            }
+        }
+    });
+    for (int i=0; i<intraQueryThreads; i++) {
+        minId = min(minId, minIds[i]);
+        maxId = max(maxId, maxIds[i]);
+    }
+}
+
+
+
+// intersact for each candidate edge, without writing anything so that threads can label edges
+// InDBit and OutABit are set if u should be added to InD(v) and v to OutA(u), see addToInDOutA()
+template<short K> short EVE::edgeLabeling(EdgeID& edgeId) {
     VertexID& u = edges[edgeId].fromId;
     VertexID& v = edges[edgeId].toId;
 
@@ -1000,85 +1763,26 @@ short EVE::edgeLabeling(EdgeID& edgeId) {
     // s->u->v -> ... -> t
     bool flag = false;
     bool flag1 = false;
+    short sides = 0;
     if (forwardDist[u]==offset+1) {
 
         // k2 = 1
         if (backwardDist[v]==offset+1) {
-            if (maxLen>4) {
-                if (isDeparture[v]==offset) {
-                    short& InDEnd = InDEnds[v];
-                    if (InDEnd<maxLen-2) {
-                        InD[v*(maxLen-2)+InDEnd] = u;
-                        InDEnd++;
-                    }
-                } else {
-                    departures[departuresEnd] = v;
-                    departuresEnd++;
-                    isDeparture[v] = offset;
-                    InD[v*(maxLen-2)] = u;
-                    InDEnds[v] = 1;
-                }
-                if (isArrival[u]==offset) {
-                    short& OutAEnd = OutAEnds[u];
-                    if (OutAEnd<maxLen-2) {
-                        OutA[u*(maxLen-2)+OutAEnd] = v;
-                        OutAEnd++;
-                    }
-                } else {
-                    arrivals[arrivalsEnd] = u;
-                    arrivalsEnd++;
-                    isArrival[u] = offset;
-                    OutA[u*(maxLen-2)] = v;
-                    OutAEnds[u] = 1;
-                }
-                
-                // statistics
-                #ifdef WRITE_STATISTICS
-                    InDoutACount += 2;
-                #endif
-            }
+            if (getMaxLen<K>()>4)
+                sides = InDBit|OutABit;
             flag = true;
             flag1 = true;
         }
 
         // k2 = 2 to maxLen-2
         if (flag==false)
-            for (int k2=2; k2<=min(maxLen-2, backwardLastLocation[v]-offset); k2++) 
+            for (int k2=2; k2<=min(getMaxLen<K>()-2, backwardLastLocation[v]-offset); k2++) 
                 if (backwardEVLen(k2, v)>=offset) {
-                    VertexID* vEVStart = &backwardEV(k2, v);
-                    VertexID* vEVEnd = vEVStart + (backwardEVLen(k2, v)-offset);
-
-                    // check have intersaction or not
-                    bool isEmpty = true;
-                    while (vEVStart != vEVEnd)
-                        if (*vEVStart==u) {
-                            isEmpty = false;
-                            break;
-                        } else
-                            vEVStart++;
 
                     // if no intersaction
-                    if (isEmpty) {
-                        if (maxLen>4) {
-                            if (isDeparture[v]==offset) {
-                                short& InDEnd = InDEnds[v];
-                                if (InDEnd<maxLen-2) {
-                                    InD[v*(maxLen-2)+InDEnd] = u;
-                                    InDEnd++;
-                                }
-                            } else {
-                                departures[departuresEnd] = v;
-                                departuresEnd++;
-                                isDeparture[v] = offset;
-                                InD[v*(maxLen-2)] = u;
-                                InDEnds[v] = 1;
-                            }
-                            
-                            // statistics
-                            #ifdef WRITE_STATISTICS
-                                InDoutACount += 1;
-                            #endif
-                        }
+                    if (!containsEV(backwardEV(k2, v), backwardEVLen(k2, v)-offset, u)) {
+                        if (getMaxLen<K>()>4)
+                            sides |= InDBit;
                         flag = true;
                         break;
                     }
@@ -1089,78 +1793,31 @@ short EVE::edgeLabeling(EdgeID& edgeId) {
     // s-> ... ->u->v->t
     if (flag1==false)
         if (backwardDist[v]==offset+1) 
-            for (int k1=2; k1<=min(maxLen-2, forwardLastLocation[u]-offset); k1++) 
+            for (int k1=2; k1<=min(getMaxLen<K>()-2, forwardLastLocation[u]-offset); k1++) 
                 if (forwardEVLen(k1, u)>=offset) {
-                    VertexID* uEVStart = &forwardEV(k1, u);
-                    VertexID* uEVEnd = uEVStart + (forwardEVLen(k1, u)-offset);
-
-                    // check have intersaction or not
-                    bool isEmpty = true;
-                    while (uEVStart != uEVEnd)
-                        if (*uEVStart==v) {
-                            isEmpty = false;
-                            break;
-                        } else
-                            uEVStart++;
 
                     // if no intersaction
-                    if (isEmpty) {
-                        if (maxLen>4) {
-                            if (isArrival[u]==offset) {
-                                short& OutAEnd = OutAEnds[u];
-                                if (OutAEnd<maxLen-2) {
-                                    OutA[u*(maxLen-2)+OutAEnd] = v;
-                                    OutAEnd++;
-                                }
-                            } else {
-                                arrivals[arrivalsEnd] = u;
-                                arrivalsEnd++;
-                                isArrival[u] = offset;
-                                OutA[u*(maxLen-2)] = v;
-                                OutAEnds[u] = 1;
-                            }
-                            
-                            // statistics
-                            #ifdef WRITE_STATISTICS
-                                InDoutACount += 1;
-                            #endif
-                        }
-                        return 2;
+                    if (!containsEV(forwardEV(k1, u), forwardEVLen(k1, u)-offset, v)) {
+                        if (getMaxLen<K>()>4)
+                            sides |= OutABit;
+                        return 2|sides;
                     }
                 }    
     if (flag)
-        return 2;
+        return 2|sides;
 
     // s-> ... -> u->v -> ... ->t
-    for (int k1=2; k1<=min(maxLen-3, forwardLastLocation[u]-offset); k1++) 
+    for (int k1=2; k1<=min(getMaxLen<K>()-3, forwardLastLocation[u]-offset); k1++) 
         if (forwardEVLen(k1, u)>=offset) {
-            VertexID* uEVStart = &forwardEV(k1, u);
-            VertexID* uEVEnd = uEVStart + (forwardEVLen(k1, u)-offset);
 
             // v->t
-            int k2 = min(maxLen-k1-1, backwardLastLocation[v]-offset);
+            int k2 = min(getMaxLen<K>()-k1-1, backwardLastLocation[v]-offset);
             while (k2>=2 && backwardEVLen(k2, v)<offset)
                 k2--;
-            if (k2>=2) {
-                VertexID* uEVStart1 = uEVStart;
-                VertexID* uEVEnd1 = uEVEnd;
-                VertexID* vEVStart = &backwardEV(k2, v);
-                VertexID* vEVEnd = vEVStart + (backwardEVLen(k2, v)-offset);
-
-                // check have intersaction or not
-                bool isEmpty = true;
-                while (uEVStart1 != uEVEnd1 && vEVStart != vEVEnd)
-                    if ((*uEVStart1)<(*vEVStart))
-                        ++uEVStart1;
-                    else if ((*uEVStart1)>(*vEVStart))
-                        ++vEVStart;
-                    else {
-                        isEmpty = false;
-                        break;
-                    }
-                if (isEmpty)
-                    return 1;
-            }
+
+            // check have intersaction or not
+            if (k2>=2 && isDisjointEV(forwardEV(k1, u), forwardEVLen(k1, u)-offset, backwardEV(k2, v), backwardEVLen(k2, v)-offset))
+                return 1;
         }
 
     return 0;
@@ -1168,35 +1825,82 @@ short EVE::edgeLabeling(EdgeID& edgeId) {
 
 
 
+// add u to InD(v) if u->v is the first edge of a path to t, and v to OutA(u) if u->v is the last edge of a path from s
+inline void EVE::addToInDOutA(VertexID& u, VertexID& v, short label) {
+    if (label&InDBit) {
+        if (isDeparture[v]==offset) {
+            short& InDEnd = InDEnds[v];
+            if (InDEnd<maxLen-2) {
+                InD[v*(kMax-2)+InDEnd] = u;
+                InDEnd++;
+            }
+        } else {
+            departures[departuresEnd] = v;
+            departuresEnd++;
+            isDeparture[v] = offset;
+            InD[v*(kMax-2)] = u;
+            InDEnds[v] = 1;
+        }
+
+        // statistics
+        #ifdef WRITE_STATISTICS
+            InDoutACount += 1;
+        #endif
+    }
+    if (label&OutABit) {
+        if (isArrival[u]==offset) {
+            short& OutAEnd = OutAEnds[u];
+            if (OutAEnd<maxLen-2) {
+                OutA[u*(kMax-2)+OutAEnd] = v;
+                OutAEnd++;
+            }
+        } else {
+            arrivals[arrivalsEnd] = u;
+            arrivalsEnd++;
+            isArrival[u] = offset;
+            OutA[u*(kMax-2)] = v;
+            OutAEnds[u] = 1;
+        }
+
+        // statistics
+        #ifdef WRITE_STATISTICS
+            InDoutACount += 1;
+        #endif
+    }
+}
+
+
+
 // for statistics
 #ifdef WRITE_STATISTICS
 
     // return space cost of current query
     double EVE::getCurrentSpaceCost() {
         double spaceCost = 0;
+        if (isAnsweredWithoutPhases)
+            return spaceCost;
 
         // propagation for essential vertices
         spaceCost += sizeof(VertexID)*maxFrontierSize;                      // nextFrontier = new VertexID[VN];
         spaceCost += sizeof(VertexID)*maxFrontierSize;                      // forwardFrontier = new VertexID[VN];
         spaceCost += sizeof(VertexID)*maxFrontierSize;                      // backwardFrontier = new VertexID[VN];
-        spaceCost += sizeof(int)*VN;                                        // forwardDist = new int[VN]();
-        spaceCost += sizeof(int)*VN;                                        // backwardDist = new int[VN]();
+        spaceCost += sizeof(Epoch)*VN;                                      // forwardDist = new Epoch[VN]();
+        spaceCost += sizeof(Epoch)*VN;                                      // backwardDist = new Epoch[VN]();
 
         // propagation for essential vertices
         if (maxLen>2) {
-            spaceCost += sizeof(VertexID)*forwardEVCount;                   // forwardEV0 = new VertexID[(maxLen-2)*VN*(maxLen-2)];
-            spaceCost += sizeof(VertexID)*backwardEVCount;                  // backwardEV0 = new VertexID[(maxLen-2)*VN*(maxLen-2)];
-            spaceCost += sizeof(int)*VN*(maxLen-2);                         // forwardEVLen0 = new int[VN*(maxLen-2)]();
-            spaceCost += sizeof(int)*VN*(maxLen-2);                         // backwardEVLen0 = new int[VN*(maxLen-2)]();
-            spaceCost += sizeof(int)*VN;                                    // forwardLastLocation = new int[VN]();
-            spaceCost += sizeof(int)*VN;                                    // backwardLastLocation = new int[VN]();
-            spaceCost += sizeof(VertexID)*(maxLen-2);                       // lastEV = new VertexID[VN*(maxLen-2)];
-            spaceCost += sizeof(int)*VN;                                    // lastEVEnds = new int[VN];
+            spaceCost += sizeof(VertexID)*forwardEVCount;                   // essential vertices in forwardEVStore pool
+            spaceCost += sizeof(VertexID)*backwardEVCount;                  // essential vertices in backwardEVStore pool
+            spaceCost += (sizeof(int)+sizeof(Epoch))*VN*2;                  // slotOf and slotStamp of both EVStores
+            spaceCost += (sizeof(VertexID*)+sizeof(Epoch)+sizeof(VertexID))*(kMax-2)*(forwardEVStore->slotEnd+backwardEVStore->slotEnd);  // EVStarts, EVLens and lastEVs of touched slots
+            spaceCost += sizeof(int)*(forwardEVStore->slotEnd+backwardEVStore->slotEnd);                                                 // lastEVEnds of touched slots
+            spaceCost += sizeof(Epoch)*VN;                                  // forwardLastLocation = new Epoch[VN]();
+            spaceCost += sizeof(Epoch)*VN;                                  // backwardLastLocation = new Epoch[VN]();
         }
 
         // edges in results
         spaceCost += sizeof(EdgeID)*(candidateEnd+1);                       // results = new EdgeID[EN+1]; candidates = results+1;
-        spaceCost += sizeof(int)*EN;                                        // isInResult = new int[EN]();
+        spaceCost += sizeof(Epoch)*EN;                                      // isInResult = new Epoch[EN]();
 
         // for verify each edge
         if (maxLen>4) {
@@ -1,7 +1,23 @@
 #ifndef EVE_H
 #define EVE_H
 #include "../GraphUtils/Graph.cc"
+#include "../GraphUtils/AnswerFile.cc"
 #include "Verification/Verification.cc"
+#include "Scheduler/Scheduler.cc"
+#include "EVStore/EVStore.cc"
+#include "EVStore/EVSetKernels.cc"
+#include "QueryTrace/QueryTrace.cc"
+#include "HopBall/HopBall.cc"
+#include "ResultCache/ResultCache.cc"
+#include "LandmarkIndex/LandmarkIndex.cc"
+
+
+
+// outputs of a query kept until written in input order
+struct QueryOutput {
+    vector<EdgeID> answer, undeterminedEdges;                                       // sorted edge ids
+    string trace;                                                                   // JSON record if tracing
+};
 
 
 
@@ -12,8 +28,31 @@ class EVE {
         EVE(Graph* inputGraph);
         EdgeID executeQuery(VertexID source, VertexID target, short k);                     // execute for each query
         void answerAllQueries(vector<PerQuery>& queries);                                   // experiments for answering all queries
+        void answerQuery(VertexID source, VertexID target, short k, vector<EdgeID>& answer);  // answer a single query with sorted edge ids
+        void answerQuery(VertexID source, VertexID target, short k, vector<EdgeID>& answer, vector<EdgeID>& undeterminedEdges);
+        void answerQueryBatch(vector<PerQuery>& queries, vector<vector<EdgeID>>& answers);  // answer queries grouped by source or target, sharing BFS balls
+
+        // skip verification and answer all edges in upper-bound graph, where results[definiteEnd, resultEnd) are undetermined
+        bool isUpperboundAnswer;
+        EdgeID definiteEnd;
         void cleanUp();                                                                     // free memory after running all queries
 
+        // time of each phase of last query in ms, recorded only if recordPhaseTimes is true
+        bool recordPhaseTimes = false;
+        double phaseTimes[EVEPhaseNumber];
+
+        // work counters and phase times of last query, recorded only if trace is not NULL
+        QueryTrace* trace = NULL;
+
+        // answers of sorted edge ids cached across queries and shared by workers, used by answerQuery() if not NULL
+        ResultCache* resultCache = NULL;
+
+        // hop distance index of a static graph shared by workers, used by executeQuery() if not NULL
+        LandmarkIndex* landmarkIndex = NULL;
+
+        // threads for large frontiers and candidates of a query, see parallelFrontierVolume and parallelCandidateNumber
+        int intraQueryThreads = 1;
+
         // return space cost of current query for statistics file
         #ifdef WRITE_STATISTICS
             double getCurrentSpaceCost();                                                   
@@ -26,44 +65,81 @@ class EVE {
         VertexID VN;                                                                        // |V| of graph
         EdgeID EN;                                                                          // |E| of graph
         PerEdge* edges;                                                                     // store all edges in graph
-        PerNeighbor *outNeighbors, *inNeighbors;                                            // neighbors of each vertex, length=EN
+        VertexID *outNeighbors, *inNeighbors;                                               // ids of neighbors of each vertex, length=EN
+        EdgeID *outNeighborEdgeIds, *inNeighborEdgeIds;                                     // ids of edges to the neighbors, only read when edges are used, length=EN
         EdgeID *outNeighborsLocator, *inNeighborsLocator;                                   // locate where to find the neighbors of a vertex, length=VN
+        EdgeID *outNeighborsLocatorEnd, *inNeighborsLocatorEnd;                             // locate where the neighbors of a vertex end, length=VN
+        int layoutVersion;                                                                  // layout version of graph arrays loaded
+        void loadGraph();
+
+        // answer queries handed out by the scheduler with this worker
+        void answerQueriesByWorker(int workerId, vector<PerQuery>* queries, Scheduler* scheduler, vector<QueryOutput>* outputs);
+
+        // per-worker query context
+        Epoch offset;                                                                       // epoch of current query, avoiding to clear arrays for each query
+        short maxLen;                                                                       // hop constraint of current query, buffers are sized by kMax
+        VertexID *forwardFrontier, forwardFrontierEnd, *backwardFrontier, backwardFrontierEnd, *nextFrontier, nextFrontierEnd;
+        Epoch *forwardDist, *backwardDist;                                                  // d(s,u) and d(u,t) with offset, length=VN
+
+        // phases specialized for maxLen of current query, chosen once per query
+        struct Specialization {
+            void (EVE::*forwardPropagation)();
+            void (EVE::*backwardPropagation)();
+            short (EVE::*edgeLabeling)(EdgeID& edgeId);
+        };
+        Specialization specialization;
+        template<short K> void specialize(short k);
+        template<short K> inline short getMaxLen() { return K>0 ? K : maxLen; }            // hop constraint in phases of K, a constant unless K=0
 
         // initialize and refresh memory for queries
         void initEVE(); 
         inline void refreshMemory();
+        inline void finishPhase(EVEPhase phase, double& phaseStartTime);
         
         // for storing neighbors of upper-bound graph
-        int *hasPrunedInNeighbors, *hasPrunedOutNeighbors;
+        Epoch *hasPrunedInNeighbors, *hasPrunedOutNeighbors;
         PerNeighbor *prunedInNeighbors, *prunedOutNeighbors;
         EdgeID *prunedInNeighborsEnd, *prunedOutNeighborsEnd;
 
+        // BFS ball shared by consecutive queries with the same source or target
+        HopBall *ball, *sharedBall, *queryBall;                                             // queryBall is sharedBall if it covers current query, otherwise NULL
+        void prepareSharedBall(vector<PerQuery>& queries, size_t i);
+
         // adaptive bi-directional BFS
         VertexID s, t, forwardMinId, forwardMaxId, backwardMinId, backwardMaxId;
         void adaptiveBiDirectBFS();
         bool continueDirection, startPropDirection;                                         // true for forward, false for backward
+        EdgeID forwardFrontierVolume, backwardFrontierVolume, nextFrontierVolume;           // number of edges to expand from each frontier
+        unsigned long long* frontierBitmap;                                                 // vertices of frontier expanded bottom-up, length=VN/64+1
+        void expandBottomUp(bool isForward, short hop, bool isMeeting);                     // unvisited vertices look for neighbors in frontier
+        void expandTopDownInParallel(bool isForward, short hop, bool isMeeting);            // chunks of frontier expanded by threads
 
         // Propagation for calculating essential vertices
-        VertexID *forwardEV0, *backwardEV0;                                                 // store essential vertices set, length=(maxLen-2)*VN*(maxLen-2)
+        EVStore *forwardEVStore, *backwardEVStore;                                          // store essential vertices sets of touched vertices only
         inline void addToEV(VertexID u, VertexID* EVStart, int EVLen);                      // add a vertex u to essential vertices set
-        int *forwardEVLen0, *backwardEVLen0;                                                // essential vertices set end-position, length=(maxLen-2)*VN
-        int *forwardLastLocation, *backwardLastLocation;                                    // last valid k for EV_k
-        VertexID *lastEV;
-        int *lastEVEnds;
-        void forwardPropagation();                          
-        void backwardPropagation();                       
+        Epoch *forwardLastLocation, *backwardLastLocation;                                  // last valid k for EV_k
+        template<short K> void forwardPropagation();                                        // K is maxLen known at compile time, or 0 for any maxLen
+        template<short K> void backwardPropagation();
+        mutex* vertexLocks;                                                                 // striped locks of vertices updated by threads, NULL until needed
+        void propagateInParallel(bool isForward, int k);                                    // hop k of propagation by threads
+        void propagateLastHopInParallel(bool isForward);                                    // hop maxLen-1 of the first propagation by threads
+        inline void addToFinalCandidatesConcurrently(EdgeID& edgeId);
 
         // edge candidates found in search
         EdgeID *candidates, candidateEnd;                                                   
         inline void addToFinalCandidates(EdgeID& edgeId);
 
         // intersaction
-        int* isInResult;
+        Epoch* isInResult;
         EdgeID *results, resultEnd;                                                         // results of edge ids, length=EN
-        short edgeLabeling(EdgeID& edgeId);                                                 // intersact for each candidate edge, return 1 if candidates, 2 if in result
+        template<short K> short edgeLabeling(EdgeID& edgeId);                               // intersact for each candidate edge, return 1 if candidates, 2 if in result, with InDBit and OutABit
+        vector<short> candidateLabels;                                                      // labels of candidates computed by threads
 
         // departures and arrivals
         VertexID *InD, *OutA, *departures, departuresEnd, *arrivals, arrivalsEnd;
+        short *InDEnds, *OutAEnds;
+        Epoch *isDeparture, *isArrival;
+        inline void addToInDOutA(VertexID& u, VertexID& v, short label);                   // add u to InD(v) and (or) v to OutA(u) by bits of label
 
         // verify undetermined edges
         inline void addToPrunedNeighbors(VertexID& u, VertexID& v, EdgeID& edgeId);
@@ -75,20 +151,38 @@ class EVE {
         #ifdef WRITE_STATISTICS
             void initStatisticStorage(int queryNumber);
             void cleanUpStatisticStorage();  
-            int queryId=0;
-            EdgeID *numOfUpperbound, *numOfAnswers, specialCnt;        
+            EdgeID *numOfUpperbound, *numOfAnswers, specialCnt, upperboundCount;        
             VertexID prunedNeighborsCount, InDoutACount, forwardEVCount, backwardEVCount, maxFrontierSize;   
             double *spaceCosts;  
+            bool isAnsweredWithoutPhases;                                               // by cache or rejected by index, with no space cost or upper-bound edges
         #endif                     
 };
 
 
 
-// storage of essential vertices for simplicity
-#define forwardEV(i,j) (forwardEV0[((i)-1)*VN*(maxLen-2)+(j)*(maxLen-2)])                   // forwardEV(k,u):      the start of EV_k(s,u)
-#define backwardEV(i,j) (backwardEV0[((i)-1)*VN*(maxLen-2)+(j)*(maxLen-2)])                 // backwardEV(k,u):     the start of EV_k(v,t)
-#define forwardEVLen(i,j) (forwardEVLen0[((i)-1)*VN+(j)])                                   // forwardEVLen(i,j):   length of EV_k(s,u)
-#define backwardEVLen(i,j) (backwardEVLen0[((i)-1)*VN+(j)])                                 // backwardEVLen(i,j):  length of EV_k(v,t)
+// expand bottom-up if edges of a frontier exceed 1/bottomUpRatio of all edges, as scanning unvisited vertices is cheaper then
+const EdgeID bottomUpRatio = 14;
+
+// a query uses its threads for frontiers of more edges or vertices, or for more candidates, handing out chunks of parallelChunkSize
+const EdgeID parallelFrontierVolume = 1<<16;
+const VertexID parallelFrontierSize = 1<<12;
+const EdgeID parallelCandidateNumber = 1<<14;
+const size_t parallelChunkSize = 256;
+
+// striped locks of vertices for parallel propagation, a power of 2
+const VertexID vertexLockNumber = 1<<12;
+
+// bits of edge label, u is added to InD(v) or v is added to OutA(u)
+const short InDBit = 4;
+const short OutABit = 8;
+
+
+
+// storage of essential vertices for simplicity, u should be touched in EVStore
+#define forwardEV(i,j) (forwardEVStore->EV(i,j))                                           // forwardEV(k,u):      the start of EV_k(s,u)
+#define backwardEV(i,j) (backwardEVStore->EV(i,j))                                         // backwardEV(k,u):     the start of EV_k(v,t)
+#define forwardEVLen(i,j) (forwardEVStore->EVLen(i,j))                                     // forwardEVLen(i,j):   length of EV_k(s,u)
+#define backwardEVLen(i,j) (backwardEVStore->EVLen(i,j))                                   // backwardEVLen(i,j):  length of EV_k(v,t)
 
 
 
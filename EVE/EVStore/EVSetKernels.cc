@@ -0,0 +1,167 @@
+#ifndef EVSETKERNELS_CC
+#define EVSETKERNELS_CC
+#include "EVSetKernels.h"
+using namespace std;
+
+
+
+// whether u is in the set, scanning the set
+bool containsEVScalar(const VertexID* set, int length, VertexID u) {
+    for (int i=0; i<length && set[i]<=u; i++)
+        if (set[i]==u)
+            return true;
+    return false;
+}
+
+
+
+// whether two sets have no common vertex, merging the sets
+bool isDisjointEVScalar(const VertexID* a, int aLength, const VertexID* b, int bLength) {
+    const VertexID* aEnd = a+aLength;
+    const VertexID* bEnd = b+bLength;
+    while (a!=aEnd && b!=bEnd)
+        if (*a<*b)
+            ++a;
+        else if (*a>*b)
+            ++b;
+        else
+            return false;
+    return true;
+}
+
+
+
+#ifdef EVSET_X86
+
+    // whether u is in the set, 8 vertices at a time, lanes beyond the set are masked out in loading and comparing
+    __attribute__((target("avx2"))) bool containsEVAVX2(const VertexID* set, int length, VertexID u) {
+        __m256i key = _mm256_set1_epi32(u);
+        int i = 0;
+        for (; i+8<=length; i+=8) {
+            __m256i block = _mm256_loadu_si256((const __m256i*)(set+i));
+            if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(block, key)))
+                return true;
+        }
+        if (i<length) {
+            __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(length-i), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+            __m256i block = _mm256_maskload_epi32((const int*)(set+i), mask);
+            if (_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi32(block, key), mask)))
+                return true;
+        }
+        return false;
+    }
+
+
+
+    // whether two sets have no common vertex, comparing each vertex of the shorter set with 8 vertices of the other at a time
+    __attribute__((target("avx2"))) bool isDisjointEVAVX2(const VertexID* a, int aLength, const VertexID* b, int bLength) {
+        if (aLength==0 || bLength==0 || a[aLength-1]<b[0] || b[bLength-1]<a[0])
+            return true;
+        if (aLength>bLength) {
+            swap(a, b);
+            swap(aLength, bLength);
+        }
+
+        // the longer set fits in one register
+        if (bLength<=8) {
+            __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(bLength), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+            __m256i block = _mm256_maskload_epi32((const int*)b, mask);
+            for (int i=0; i<aLength; i++)
+                if (_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi32(block, _mm256_set1_epi32(a[i])), mask)))
+                    return false;
+            return true;
+        }
+        for (int i=0; i<aLength; i++)
+            if (containsEVAVX2(b, bLength, a[i]))
+                return false;
+        return true;
+    }
+
+
+
+    // whether u is in the set, 16 vertices at a time with masks for the tail
+    __attribute__((target("avx512f"))) bool containsEVAVX512(const VertexID* set, int length, VertexID u) {
+        __m512i key = _mm512_set1_epi32(u);
+        for (int i=0; i<length; i+=16) {
+            __mmask16 mask = length-i>=16 ? 0xFFFF : (__mmask16)((1u<<(length-i))-1);
+            __m512i block = _mm512_maskz_loadu_epi32(mask, set+i);
+            if (_mm512_mask_cmpeq_epi32_mask(mask, block, key))
+                return true;
+        }
+        return false;
+    }
+
+
+
+    // whether two sets have no common vertex, comparing each vertex of the shorter set with 16 vertices of the other at a time
+    __attribute__((target("avx512f"))) bool isDisjointEVAVX512(const VertexID* a, int aLength, const VertexID* b, int bLength) {
+        if (aLength==0 || bLength==0 || a[aLength-1]<b[0] || b[bLength-1]<a[0])
+            return true;
+        if (aLength>bLength) {
+            swap(a, b);
+            swap(aLength, bLength);
+        }
+
+        // the longer set fits in one register
+        if (bLength<=16) {
+            __mmask16 mask = (__mmask16)((1u<<bLength)-1);
+            __m512i block = _mm512_maskz_loadu_epi32(mask, b);
+            for (int i=0; i<aLength; i++)
+                if (_mm512_mask_cmpeq_epi32_mask(mask, block, _mm512_set1_epi32(a[i])))
+                    return false;
+            return true;
+        }
+        for (int i=0; i<aLength; i++)
+            if (containsEVAVX512(b, bLength, a[i]))
+                return false;
+        return true;
+    }
+
+#endif
+
+
+
+// select kernels by name (auto/scalar/avx2/avx512), return false if not supported by CPU
+bool selectEVSetKernels(string name) {
+    #ifdef EVSET_X86
+        __builtin_cpu_init();
+        bool hasAVX512 = sizeof(VertexID)==4 && __builtin_cpu_supports("avx512f");
+        bool hasAVX2 = sizeof(VertexID)==4 && __builtin_cpu_supports("avx2");
+        if (name=="auto")
+            name = hasAVX512 ? "avx512" : (hasAVX2 ? "avx2" : "scalar");
+        if (name=="avx512" && hasAVX512) {
+            containsEV = containsEVAVX512;
+            isDisjointEV = isDisjointEVAVX512;
+            EVSetKernelsName = name;
+            return true;
+        }
+        if (name=="avx2" && hasAVX2) {
+            containsEV = containsEVAVX2;
+            isDisjointEV = isDisjointEVAVX2;
+            EVSetKernelsName = name;
+            return true;
+        }
+    #else
+        if (name=="auto")
+            name = "scalar";
+    #endif
+    if (name=="scalar") {
+        containsEV = containsEVScalar;
+        isDisjointEV = isDisjointEVScalar;
+        EVSetKernelsName = name;
+        return true;
+    }
+    return false;
+}
+
+
+
+// kernels in use, selected by CPU at start
+bool (*containsEV)(const VertexID* set, int length, VertexID u) = containsEVScalar;
+bool (*isDisjointEV)(const VertexID* a, int aLength, const VertexID* b, int bLength) = isDisjointEVScalar;
+string EVSetKernelsName = "scalar";
+bool isEVSetKernelsSelected = selectEVSetKernels("auto");
+
+
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef EVSETKERNELS_H
+#define EVSETKERNELS_H
+#include "../../GraphUtils/Utils.h"
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #define EVSET_X86
+#endif
+
+
+
+/*
+Kernels on essential vertices sets, which are short and sorted in ascending order.
+- containsEV(set, length, u):           whether u is in the set
+- isDisjointEV(a, aLength, b, bLength): whether two sets have no common vertex
+AVX-512 or AVX2 kernels are selected at runtime by the CPU, with scalar kernels as fallback.
+*/
+extern bool (*containsEV)(const VertexID* set, int length, VertexID u);
+extern bool (*isDisjointEV)(const VertexID* a, int aLength, const VertexID* b, int bLength);
+
+// select kernels by name (auto/scalar/avx2/avx512), return false if not supported by CPU
+bool selectEVSetKernels(string name);
+
+// name of selected kernels
+extern string EVSetKernelsName;
+
+
+
+#endif
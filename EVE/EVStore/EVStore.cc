@@ -0,0 +1,161 @@
+#ifndef EVSTORE_CC
+#define EVSTORE_CC
+#include "EVStore.h"
+using namespace std;
+
+
+
+EVStore::EVStore(VertexID inputVN, short inputWidth) {
+    VN = inputVN;
+    width = inputWidth;
+    offset = 0;
+
+    // slots of touched vertices
+    slotOf = new int[VN];
+    slotStamp = new Epoch[VN]();
+    slotCapacity = 1024;
+    slotEnd = 0;
+    EVStarts = new VertexID*[slotCapacity*width];
+    EVLens = new Epoch[slotCapacity*width];
+    lastEVs = new VertexID[slotCapacity*width];
+    lastEVEnds = new int[slotCapacity];
+
+    // pool
+    setArenaNumber(1);
+}
+
+
+
+// reuse slots and pool for a new query
+void EVStore::refresh(Epoch inputOffset) {
+    offset = inputOffset;
+    slotEnd = 0;
+    for (EVArena& arena : arenas)
+        arena.blockId = arena.blockEnd = 0;
+}
+
+
+
+// clear slot stamps when offset restarts from 0
+void EVStore::reset() {
+    memset(slotStamp, 0, sizeof(Epoch)*VN);
+}
+
+
+
+// slot of vertex u, allocated at the first touch in current query
+inline int EVStore::touch(VertexID u) {
+    if (slotStamp[u]!=offset) {
+        if (slotEnd==slotCapacity)
+            growSlots();
+        slotStamp[u] = offset;
+        slotOf[u] = slotEnd;
+        memset(EVLens+slotEnd*width, 0, sizeof(Epoch)*width);
+        lastEVEnds[slotEnd] = 0;
+        slotEnd++;
+    }
+    return slotOf[u];
+}
+
+
+
+// slot of vertex u touched by threads, which take slots reserved by reserve()
+inline int EVStore::touchConcurrently(VertexID u) {
+    if (slotStamp[u]!=offset) {
+        int slot = __sync_fetch_and_add(&slotEnd, 1);
+        memset(EVLens+slot*width, 0, sizeof(Epoch)*width);
+        lastEVEnds[slot] = 0;
+        slotOf[u] = slot;
+        slotStamp[u] = offset;
+    }
+    return slotOf[u];
+}
+
+
+
+// grow slots until slotNumber more vertices can be touched
+void EVStore::reserve(int slotNumber) {
+    while (slotEnd+slotNumber>slotCapacity)
+        growSlots();
+}
+
+
+
+// double the number of slots
+void EVStore::growSlots() {
+    int newCapacity = slotCapacity*2;
+    VertexID** newEVStarts = new VertexID*[newCapacity*width];
+    Epoch* newEVLens = new Epoch[newCapacity*width];
+    VertexID* newLastEVs = new VertexID[newCapacity*width];
+    int* newLastEVEnds = new int[newCapacity];
+    memcpy(newEVStarts, EVStarts, sizeof(VertexID*)*slotEnd*width);
+    memcpy(newEVLens, EVLens, sizeof(Epoch)*slotEnd*width);
+    memcpy(newLastEVs, lastEVs, sizeof(VertexID)*slotEnd*width);
+    memcpy(newLastEVEnds, lastEVEnds, sizeof(int)*slotEnd);
+    delete[] EVStarts;
+    delete[] EVLens;
+    delete[] lastEVs;
+    delete[] lastEVEnds;
+    EVStarts = newEVStarts;
+    EVLens = newEVLens;
+    lastEVs = newLastEVs;
+    lastEVEnds = newLastEVEnds;
+    slotCapacity = newCapacity;
+}
+
+
+
+// allocate space for a set from an arena, blocks are kept for later queries
+inline VertexID* EVStore::allocate(int length, int arenaId) {
+    EVArena& arena = arenas[arenaId];
+    if (arena.blockEnd+length>EVPoolBlockSize) {
+        arena.blockId++;
+        arena.blockEnd = 0;
+        if (arena.blockId==arena.blocks.size())
+            arena.blocks.push_back(new VertexID[EVPoolBlockSize]);
+    }
+    VertexID* start = arena.blocks[arena.blockId]+arena.blockEnd;
+    arena.blockEnd += length;
+    return start;
+}
+
+
+
+// arenas for threads of a propagation level, kept for later queries
+void EVStore::setArenaNumber(int arenaNumber) {
+    while ((int)arenas.size()<arenaNumber) {
+        arenas.push_back(EVArena());
+        arenas.back().blocks.push_back(new VertexID[EVPoolBlockSize]);
+        arenas.back().blockId = arenas.back().blockEnd = 0;
+    }
+}
+
+
+
+// number of vertex ids allocated in pool for current query
+size_t EVStore::poolSize() {
+    size_t size = 0;
+    for (EVArena& arena : arenas)
+        size += arena.blockId*EVPoolBlockSize+arena.blockEnd;
+    return size;
+}
+
+
+
+// clean up memories allocated
+void EVStore::cleanUp() {
+    delete[] slotOf;
+    delete[] slotStamp;
+    delete[] EVStarts;
+    delete[] EVLens;
+    delete[] lastEVs;
+    delete[] lastEVEnds;
+    for (EVArena& arena : arenas)
+        for (VertexID* block : arena.blocks)
+            delete[] block;
+    arenas.clear();
+}
+
+
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef EVSTORE_H
+#define EVSTORE_H
+#include "../../GraphUtils/Graph.cc"
+
+
+
+/*
+Essential vertices sets of one propagation direction.
+Only vertices touched by the current query get a slot, which keeps EV_k(u) for every k.
+The sets themselves are appended to a pool of fixed-size blocks, so memory follows
+the number of essential vertices actually stored instead of (maxLen-2)^2*VN.
+For a propagation level run by threads, slots are reserved beforehand and each thread allocates from its own arena of blocks.
+*/
+class EVStore {
+
+    public:
+
+        EVStore(VertexID inputVN, short inputWidth);
+        void refresh(Epoch inputOffset);                                    // reuse slots and pool for a new query
+        void reset();                                                       // clear slot stamps when offset restarts
+        void cleanUp();
+
+        // slot of vertex u, allocated at the first touch in current query
+        inline int touch(VertexID u);
+        void reserve(int slotNumber);                                       // room for slotNumber more slots without growing
+        inline int touchConcurrently(VertexID u);                           // touch by threads after reserve(), u is locked by the caller
+
+        // for touched vertex u and 1<=k<=width
+        inline VertexID*& EV(int k, VertexID u) { return EVStarts[slotOf[u]*width+k-1]; }         // start of EV_k(u) in pool
+        inline Epoch& EVLen(int k, VertexID u) { return EVLens[slotOf[u]*width+k-1]; }            // length of EV_k(u) with offset, smaller than offset if not exists
+        inline VertexID* lastEV(VertexID u) { return lastEVs+slotOf[u]*width; }                   // last essential vertices set
+        inline int& lastEVEnd(VertexID u) { return lastEVEnds[slotOf[u]]; }
+
+        // allocate space for a set from pool, or from arena of a thread
+        inline VertexID* allocate(int length, int arenaId = 0);
+        void setArenaNumber(int arenaNumber);
+
+        // for statistics
+        int slotEnd;
+        size_t poolSize();
+
+    private:
+
+        VertexID VN;
+        short width;                                                        // number of hops having essential vertices, i.e., maxLen-2
+        Epoch offset;
+
+        // slots of touched vertices
+        int* slotOf;
+        Epoch* slotStamp;                                                   // slot of each vertex, valid if stamp equals offset, length=VN
+        int slotCapacity;
+        VertexID** EVStarts;
+        Epoch* EVLens;
+        int* lastEVEnds;
+        VertexID* lastEVs;
+        void growSlots();
+
+        // pool of fixed-size blocks, arena 0 for single thread
+        struct EVArena {
+            vector<VertexID*> blocks;
+            size_t blockId, blockEnd;
+        };
+        vector<EVArena> arenas;
+};
+
+
+
+// size of each block in pool
+const size_t EVPoolBlockSize = 1<<16;
+
+
+
+#endif
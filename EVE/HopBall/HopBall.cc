@@ -0,0 +1,88 @@
+#ifndef HOPBALL_CC
+#define HOPBALL_CC
+#include "HopBall.h"
+using namespace std;
+
+
+
+HopBall::HopBall(Graph* inputGraph) {
+    graph = inputGraph;
+    VN = graph->VN;
+    vertices = new VertexID[VN];
+    levelEnd = new VertexID[kMax+1];
+    dist = new short[VN];
+    distStamp = new Epoch[VN]();
+    stamp = 0;
+}
+
+
+
+// start a new ball with level 0 only
+void HopBall::reset(VertexID inputCenter, bool inputIsForward) {
+    center = inputCenter;
+    isForward = inputIsForward;
+
+    // refresh stamp
+    if (stamp==maxEpoch-1) {
+        stamp = 0;
+        memset(distStamp, 0, sizeof(Epoch)*VN);
+    }
+    stamp++;
+
+    // level 0 is the center
+    vertices[0] = center;
+    levelEnd[0] = 1;
+    dist[center] = 0;
+    distStamp[center] = stamp;
+    builtRadius = 0;
+    isComplete = false;
+}
+
+
+
+// build levels up to hop h
+inline void HopBall::extendTo(short h) {
+    while (builtRadius<h && builtRadius<kMax)
+        buildNextLevel();
+}
+
+
+
+// BFS for one more level
+void HopBall::buildNextLevel() {
+    EdgeID* locator = isForward ? graph->outNeighborsLocator : graph->inNeighborsLocator;
+    EdgeID* locatorEnd = isForward ? graph->outNeighborsLocatorEnd : graph->inNeighborsLocatorEnd;
+    VertexID* neighbors = isForward ? graph->outNeighbors : graph->inNeighbors;
+    short h = builtRadius+1;
+    VertexID end = levelEnd[h-1];
+    for (VertexID i=(h>1 ? levelEnd[h-2] : 0); i<levelEnd[h-1]; i++) {
+        VertexID& u = vertices[i];
+        for (EdgeID edgeLocator=locator[u]; edgeLocator<locatorEnd[u]; edgeLocator++) {
+            VertexID& v = neighbors[edgeLocator];
+            if (distStamp[v]!=stamp) {
+                distStamp[v] = stamp;
+                dist[v] = h;
+                vertices[end] = v;
+                end++;
+            }
+        }
+    }
+    levelEnd[h] = end;
+    builtRadius = h;
+    if (end==levelEnd[h-1])
+        isComplete = true;
+}
+
+
+
+// free up memories
+void HopBall::cleanUp() {
+    delete[] vertices;
+    delete[] levelEnd;
+    delete[] dist;
+    delete[] distStamp;
+}
+
+
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef HOPBALL_H
+#define HOPBALL_H
+#include "../../GraphUtils/Graph.cc"
+
+
+
+/*
+Vertices within a few hops from a center, shared by consecutive queries with the same source (forward ball over
+out-edges) or the same target (backward ball over in-edges). Levels are built lazily as deep as queries need them,
+and vertices are kept in BFS order, so that the level of hop h is vertices[levelEnd[h-1], levelEnd[h]).
+Essential vertices sets can not be shared in the same way, since they are over paths avoiding the other end of a query.
+*/
+class HopBall {
+
+    public:
+
+        HopBall(Graph* inputGraph);
+        void reset(VertexID inputCenter, bool inputIsForward);             // start a new ball with level 0 only
+        inline void extendTo(short h);                                      // build levels up to hop h
+        void cleanUp();
+
+        // hop distance from (or to) center, builtRadius+1 if not found yet, kMax+1 if unreachable
+        inline short getDist(VertexID u) { return distStamp[u]==stamp ? dist[u] : (isComplete ? kMax+1 : builtRadius+1); }
+
+        // whether the ball can be used for a query
+        inline bool covers(VertexID s, VertexID t) { return isForward ? center==s : center==t; }
+
+        VertexID center;
+        bool isForward;                                                     // true for out-edges from center, false for in-edges to center
+        short builtRadius;                                                  // levels built so far
+        bool isComplete;                                                    // all vertices reachable are in ball
+        VertexID *vertices, *levelEnd;                                      // vertices in BFS order, length=VN, and end of each level, length=kMax+1
+
+    private:
+
+        Graph* graph;
+        VertexID VN;
+        short* dist;                                                        // hop distance of vertices in ball, length=VN
+        Epoch *distStamp, stamp;                                            // dist[u] is valid if distStamp[u]==stamp
+        void buildNextLevel();
+};
+
+
+
+#endif
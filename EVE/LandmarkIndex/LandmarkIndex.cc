@@ -0,0 +1,111 @@
+#ifndef LANDMARKINDEX_CC
+#define LANDMARKINDEX_CC
+#include "LandmarkIndex.h"
+using namespace std;
+
+
+
+LandmarkIndex::LandmarkIndex(Graph* inputGraph, int inputLandmarkNumber) {
+    double startTime = getCurrentTimeInMs();
+    VN = inputGraph->VN;
+    landmarkNumber = min(inputLandmarkNumber, int(VN));
+
+    // landmarks of largest degrees, which are on many short paths
+    vector<pair<EdgeID, VertexID>> degrees(VN);
+    for (VertexID u=0; u<VN; u++)
+        degrees[u] = {inputGraph->outNeighborsLocatorEnd[u]-inputGraph->outNeighborsLocator[u]+inputGraph->inNeighborsLocatorEnd[u]-inputGraph->inNeighborsLocator[u], u};
+    partial_sort(degrees.begin(), degrees.begin()+landmarkNumber, degrees.end(), [](const pair<EdgeID, VertexID>& a, const pair<EdgeID, VertexID>& b) {
+        return a.first>b.first || (a.first==b.first && a.second<b.second);
+    });
+    landmarks = new VertexID[landmarkNumber];
+    for (int i=0; i<landmarkNumber; i++)
+        landmarks[i] = degrees[i].second;
+
+    // BFS from and to each landmark in parallel, with distances of each landmark kept together
+    unsigned char* distOfLandmarks = new unsigned char[(size_t)VN*landmarkNumber*2];
+    parallelFor(landmarkNumber*2, [this, inputGraph, distOfLandmarks](int threadId, size_t begin, size_t end) {
+        VertexID* queue = new VertexID[VN];
+        for (size_t i=begin; i<end; i++)
+            buildDistances(inputGraph, landmarks[i/2], i%2==0, distOfLandmarks+(size_t)VN*i, queue);
+        delete[] queue;
+    });
+
+    // distances of each vertex are then kept together, so that a query reads a few cache lines
+    distFromLandmarks = new unsigned char[(size_t)VN*landmarkNumber];
+    distToLandmarks = new unsigned char[(size_t)VN*landmarkNumber];
+    parallelFor(VN, [this, distOfLandmarks](int threadId, size_t begin, size_t end) {
+        for (size_t u=begin; u<end; u++)
+            for (int i=0; i<landmarkNumber; i++) {
+                distFromLandmarks[u*landmarkNumber+i] = distOfLandmarks[(size_t)VN*(i*2)+u];
+                distToLandmarks[u*landmarkNumber+i] = distOfLandmarks[(size_t)VN*(i*2+1)+u];
+            }
+    });
+    delete[] distOfLandmarks;
+    buildTime = getCurrentTimeInMs()-startTime;
+}
+
+
+
+// BFS from landmark over out-edges, or to landmark over in-edges
+void LandmarkIndex::buildDistances(Graph* graph, VertexID landmark, bool isForward, unsigned char* dist, VertexID* queue) {
+    EdgeID* locator = isForward ? graph->outNeighborsLocator : graph->inNeighborsLocator;
+    EdgeID* locatorEnd = isForward ? graph->outNeighborsLocatorEnd : graph->inNeighborsLocatorEnd;
+    VertexID* neighbors = isForward ? graph->outNeighbors : graph->inNeighbors;
+    memset(dist, unreachableDist, sizeof(unsigned char)*VN);
+    dist[landmark] = 0;
+    queue[0] = landmark;
+    for (VertexID queueStart=0, queueEnd=1; queueStart<queueEnd; queueStart++) {
+        VertexID& u = queue[queueStart];
+        unsigned char nextDist = min(dist[u]+1, int(saturatedDist));
+        for (EdgeID edgeLocator=locator[u]; edgeLocator<locatorEnd[u]; edgeLocator++) {
+            VertexID& v = neighbors[edgeLocator];
+            if (dist[v]==unreachableDist) {
+                dist[v] = nextDist;
+                queue[queueEnd++] = v;
+            }
+        }
+    }
+}
+
+
+
+// lower bound of d(s,t) by all landmarks, unreachableDist if t is not reachable from s
+short LandmarkIndex::getDistLowerBound(VertexID s, VertexID t) {
+    unsigned char* fromLandmarksToS = distFromLandmarks+(size_t)s*landmarkNumber;
+    unsigned char* fromLandmarksToT = distFromLandmarks+(size_t)t*landmarkNumber;
+    unsigned char* fromSToLandmarks = distToLandmarks+(size_t)s*landmarkNumber;
+    unsigned char* fromTToLandmarks = distToLandmarks+(size_t)t*landmarkNumber;
+    short bound = 0;
+    for (int i=0; i<landmarkNumber; i++) {
+
+        // L->s->t
+        if (fromLandmarksToS[i]!=unreachableDist) {
+            if (fromLandmarksToT[i]==unreachableDist)
+                return unreachableDist;
+            if (fromLandmarksToS[i]<saturatedDist)
+                bound = max(bound, short(fromLandmarksToT[i]-fromLandmarksToS[i]));
+        }
+
+        // s->t->L
+        if (fromTToLandmarks[i]!=unreachableDist) {
+            if (fromSToLandmarks[i]==unreachableDist)
+                return unreachableDist;
+            if (fromTToLandmarks[i]<saturatedDist)
+                bound = max(bound, short(fromSToLandmarks[i]-fromTToLandmarks[i]));
+        }
+    }
+    return bound;
+}
+
+
+
+// free up memories
+void LandmarkIndex::cleanUp() {
+    delete[] landmarks;
+    delete[] distFromLandmarks;
+    delete[] distToLandmarks;
+}
+
+
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef LANDMARKINDEX_H
+#define LANDMARKINDEX_H
+#include "../../GraphUtils/Graph.cc"
+
+
+
+/*
+Hop distances from and to a few landmarks of large degrees, giving lower bounds of d(s,t) without any search:
+- d(s,t) >= d(L,t)-d(L,s), and t is not reachable from s if s is reachable from L but t is not
+- d(s,t) >= d(s,L)-d(t,L), and t is not reachable from s if t can reach L but s can not
+Queries with a lower bound larger than k have no path, and are rejected before BFS.
+Distances are kept in one byte, saturated at saturatedDist, so bounds are only taken from exact distances of the subtracted side.
+The index is built for a static graph, since inserted edges can shorten distances.
+*/
+class LandmarkIndex {
+
+    public:
+
+        LandmarkIndex(Graph* inputGraph, int inputLandmarkNumber);
+        short getDistLowerBound(VertexID s, VertexID t);                   // unreachableDist if t is not reachable from s
+        void cleanUp();
+
+        // for logs
+        int landmarkNumber;
+        double buildTime;                                                   // in ms
+        size_t getSize() { return sizeof(unsigned char)*VN*landmarkNumber*2; }   // in bytes
+
+    private:
+
+        VertexID VN;
+        VertexID* landmarks;
+        unsigned char *distFromLandmarks, *distToLandmarks;                // d(L_i,u) and d(u,L_i) at u*landmarkNumber+i, length=VN*landmarkNumber
+        void buildDistances(Graph* graph, VertexID landmark, bool isForward, unsigned char* dist, VertexID* queue);   // dist of length VN
+};
+
+// distances of at least saturatedDist are kept as saturatedDist
+const unsigned char saturatedDist = 254;
+const unsigned char unreachableDist = 255;
+
+
+
+#endif
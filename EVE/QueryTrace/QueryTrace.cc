@@ -0,0 +1,61 @@
+#ifndef QUERYTRACE_CC
+#define QUERYTRACE_CC
+#include "QueryTrace.h"
+using namespace std;
+
+
+
+// clear counters for a new query, keeping capacity of vectors
+void QueryTrace::reset(VertexID inputSource, VertexID inputTarget, short inputK) {
+    source = inputSource;
+    target = inputTarget;
+    k = inputK;
+    memset(phaseTimes, 0, sizeof(phaseTimes));
+    forwardFrontierSizes.clear();
+    backwardFrontierSizes.clear();
+    forwardEVSizes.assign(max(k-1, 1), 0);
+    backwardEVSizes.assign(max(k-1, 1), 0);
+    candidateEdges = undeterminedEdges = definiteEdges = answerEdges = 0;
+    forwardDFSNodes = backwardDFSNodes = deadEndHits = 0;
+    useSearchOrderingStrategy = cacheHit = rejectedByIndex = false;
+}
+
+
+
+// write values of a vector as a JSON array
+template<typename T>
+void writeJSONArray(ostringstream& out, vector<T>& values, size_t start) {
+    out<<"[";
+    for (size_t i=start; i<values.size(); i++)
+        out<<(i>start ? "," : "")<<values[i];
+    out<<"]";
+}
+
+
+
+// record of the query as one JSON line
+string QueryTrace::toJSON() {
+    ostringstream out;
+    out<<"{\"source\":"<<source<<",\"target\":"<<target<<",\"k\":"<<k;
+    out<<",\"phaseTimes\":{";
+    for (int phase=0; phase<EVEPhaseNumber; phase++)
+        out<<(phase>0 ? "," : "")<<"\""<<EVEPhaseNames[phase]<<"\":"<<phaseTimes[phase];
+    out<<"},\"forwardFrontierSizes\":";
+    writeJSONArray(out, forwardFrontierSizes, 0);
+    out<<",\"backwardFrontierSizes\":";
+    writeJSONArray(out, backwardFrontierSizes, 0);
+    out<<",\"forwardEVSizes\":";
+    writeJSONArray(out, forwardEVSizes, 1);
+    out<<",\"backwardEVSizes\":";
+    writeJSONArray(out, backwardEVSizes, 1);
+    out<<",\"candidateEdges\":"<<candidateEdges<<",\"undeterminedEdges\":"<<undeterminedEdges<<",\"definiteEdges\":"<<definiteEdges;
+    out<<",\"forwardDFSNodes\":"<<forwardDFSNodes<<",\"backwardDFSNodes\":"<<backwardDFSNodes<<",\"deadEndHits\":"<<deadEndHits;
+    out<<",\"useSearchOrderingStrategy\":"<<(useSearchOrderingStrategy ? "true" : "false");
+    out<<",\"cacheHit\":"<<(cacheHit ? "true" : "false")<<",\"rejectedByIndex\":"<<(rejectedByIndex ? "true" : "false");
+    out<<",\"answerEdges\":"<<answerEdges<<"}";
+    return out.str();
+}
+
+
+
+#endif
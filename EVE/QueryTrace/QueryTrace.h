@@ -0,0 +1,40 @@
+#ifndef QUERYTRACE_H
+#define QUERYTRACE_H
+#include "../../GraphUtils/Utils.h"
+
+
+
+// phases of answering a query
+enum EVEPhase {BFSPhase, propagationPhase, labelingPhase, verificationPhase, EVEPhaseNumber};
+const char* EVEPhaseNames[EVEPhaseNumber] = {"BFS", "propagation", "labeling", "verification"};
+
+
+
+/*
+Work counters of one query, recorded only when tracing is enabled, written as a JSON line per query.
+- forwardFrontierSizes / backwardFrontierSizes: frontier size of each BFS level in each direction
+- forwardEVSizes / backwardEVSizes:             total size of EV_k sets of each k (index 0 is unused)
+- undeterminedEdges / definiteEdges:            number of edge labeling returning 1 / 2
+- forwardDFSNodes / backwardDFSNodes:           vertices expanded by forward / backward DFS in verification
+- deadEndHits:                                  final searches of DFS skipped by a former failure from the same vertex
+- useSearchOrderingStrategy:                    whether verification sorted pruned neighbors
+- cacheHit:                                     whether the answer is from result cache, without any phase
+- rejectedByIndex:                              whether the landmark index bounds d(s,t) above k, without any phase
+*/
+struct QueryTrace {
+    VertexID source, target;
+    short k;
+    double phaseTimes[EVEPhaseNumber];
+    vector<VertexID> forwardFrontierSizes, backwardFrontierSizes;
+    vector<unsigned long long> forwardEVSizes, backwardEVSizes;
+    EdgeID candidateEdges, undeterminedEdges, definiteEdges, answerEdges;
+    unsigned long long forwardDFSNodes, backwardDFSNodes, deadEndHits;
+    bool useSearchOrderingStrategy, cacheHit, rejectedByIndex;
+
+    void reset(VertexID inputSource, VertexID inputTarget, short inputK);   // clear counters for a new query
+    string toJSON();                                                        // record of the query as one JSON line
+};
+
+
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef RESULTCACHE_CC
+#define RESULTCACHE_CC
+#include "ResultCache.h"
+using namespace std;
+
+
+
+ResultCache::ResultCache(size_t inputBudget, bool inputIsMonotonic) {
+    budget = inputBudget;
+    isMonotonic = inputIsMonotonic;
+    size = 0;
+    hits = misses = 0;
+}
+
+
+
+// copy the answer of (s,t,k) if cached or implied by cached answers of (s,t), return false if missed
+bool ResultCache::lookup(VertexID s, VertexID t, short k, vector<EdgeID>& answer) {
+    lock_guard<mutex> lock(cacheLock);
+    auto pairEntries = entriesOfPair.find(getPairKey(s, t));
+    if (pairEntries!=entriesOfPair.end()) {
+        map<short, list<CacheEntry>::iterator>& entriesByK = pairEntries->second;
+        auto upper = entriesByK.lower_bound(k);
+
+        // the same k
+        if (upper!=entriesByK.end() && upper->first==k) {
+            touch(upper->second);
+            answer = upper->second->answer;
+            hits++;
+            return true;
+        }
+
+        // an empty answer of larger k
+        if (isMonotonic && upper!=entriesByK.end() && upper->second->answer.empty()) {
+            touch(upper->second);
+            answer.clear();
+            hits++;
+            return true;
+        }
+
+        // the same answers of a smaller k and a larger k
+        if (isMonotonic && upper!=entriesByK.end() && upper!=entriesByK.begin()) {
+            auto lower = prev(upper);
+            if (lower->second->answer==upper->second->answer) {
+                touch(lower->second);
+                touch(upper->second);
+                answer = upper->second->answer;
+                hits++;
+                return true;
+            }
+        }
+    }
+    misses++;
+    return false;
+}
+
+
+
+// cache the sorted answer of (s,t,k), evicting least recently used answers out of budget
+void ResultCache::insert(VertexID s, VertexID t, short k, EdgeID* answer, EdgeID answerLength) {
+    size_t entrySize = getEntrySize(answerLength);
+    if (entrySize>budget)
+        return;
+    lock_guard<mutex> lock(cacheLock);
+
+    // already cached by another worker
+    unsigned long long pairKey = getPairKey(s, t);
+    map<short, list<CacheEntry>::iterator>& entriesByK = entriesOfPair[pairKey];
+    if (entriesByK.count(k)) {
+        touch(entriesByK[k]);
+        return;
+    }
+    entries.push_front({pairKey, k, vector<EdgeID>(answer, answer+answerLength)});
+    entriesByK[k] = entries.begin();
+    size += entrySize;
+    while (size>budget)
+        evictLast();
+}
+
+
+
+// evict the least recently used answer
+void ResultCache::evictLast() {
+    CacheEntry& entry = entries.back();
+    size -= getEntrySize(entry.answer.size());
+    auto pairEntries = entriesOfPair.find(entry.pairKey);
+    pairEntries->second.erase(entry.k);
+    if (pairEntries->second.empty())
+        entriesOfPair.erase(pairEntries);
+    entries.pop_back();
+}
+
+
+
+// drop all answers, e.g., after the graph is updated
+void ResultCache::clear() {
+    lock_guard<mutex> lock(cacheLock);
+    entries.clear();
+    entriesOfPair.clear();
+    size = 0;
+}
+
+
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+#include "../../GraphUtils/Utils.h"
+
+
+
+/*
+Answers of recent queries in sorted edge ids, shared by workers and evicted in least recently used order within a memory budget.
+Exact answers are monotonic in k, i.e., the answer of k-1 is a subset of the answer of k, so that a query (s,t,k) also hits
+- an empty answer of (s,t,k') with k'>k, since answers of smaller k are empty as well
+- the same answers of (s,t,k1) and (s,t,k2) with k1<k<k2, which are the answer of k as well
+*/
+class ResultCache {
+
+    public:
+
+        ResultCache(size_t inputBudget, bool inputIsMonotonic);            // budget in bytes, monotonic only for exact answers
+        bool lookup(VertexID s, VertexID t, short k, vector<EdgeID>& answer);   // return false if missed
+        void insert(VertexID s, VertexID t, short k, EdgeID* answer, EdgeID answerLength);
+        void clear();                                                       // drop all answers, e.g., after the graph is updated
+
+        // for logs
+        unsigned long long hits, misses;
+        double getHitRate() { return hits+misses>0 ? (double)hits/(hits+misses) : 0; }
+
+    private:
+
+        // entries in least recently used order, and entries of each (s,t) by k
+        struct CacheEntry {
+            unsigned long long pairKey;
+            short k;
+            vector<EdgeID> answer;
+        };
+        list<CacheEntry> entries;                                           // most recently used first
+        unordered_map<unsigned long long, map<short, list<CacheEntry>::iterator>> entriesOfPair;
+        inline unsigned long long getPairKey(VertexID s, VertexID t) { return ((unsigned long long)s<<32)|t; }
+        inline void touch(list<CacheEntry>::iterator entry) { entries.splice(entries.begin(), entries, entry); }
+        inline size_t getEntrySize(size_t answerLength) { return sizeof(CacheEntry)+cacheEntryOverhead+sizeof(EdgeID)*answerLength; }
+        void evictLast();
+
+        size_t budget, size;                                                // in bytes
+        bool isMonotonic;
+        mutex cacheLock;
+        static const size_t cacheEntryOverhead = 64;                        // nodes of list and maps
+};
+
+
+
+#endif
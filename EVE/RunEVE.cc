@@ -1,4 +1,5 @@
 #include "EVE.cc"
+#include "Server/Server.cc"
 using namespace std;
 
 
@@ -7,12 +8,64 @@ int main(int argc, char *argv[]) {
 
     // program input parameters
     if(argc < 4) {
-        cout << "Usage: ./RunEVE <Graph File> <Query File> <Hop Constraint k>" << endl;
+        cout << "Usage: ./RunEVE <Graph File> <Query File> <Hop Constraint k> [--kmax=<Max Hop Constraint>] [--answer=<exact|upperbound>] [--tag=<on|off>] [--output=<text|binary|zstd|none>] [--trace=<on|off>] [--batch=<on|off>] [--order=<none|degree|bfs|rcm>] [--bottomup=<on|off>] [--cache=<Budget in MB>] [--landmarks=<Number of Landmarks>] [--threads=<Number of Threads>] [--intra=<Threads per Query>]" << endl;
+        cout << "       ./RunEVE <Graph File> --server <Hop Constraint k> [--kmax=<Max Hop Constraint>] [--answer=<exact|upperbound>] [--tag=<on|off>] [--updates=<on|off>] [--compaction=<Interval in ms>] [--order=<none|degree|bfs|rcm>] [--bottomup=<on|off>] [--cache=<Budget in MB>] [--landmarks=<Number of Landmarks>] [--socket=<Socket Path>] [--threads=<Number of Threads>]" << endl;
         exit(1);
     }
     graphFilename = extractFilename(argv[1]); 
     queryFilename = extractFilename(argv[2]); 
     maxLen = stoi(argv[3]);
+    kMax = max(maxLen, (short)stoi(getOption(argc, argv, "kmax", "0")));
+    numOfThreads = stoi(getOption(argc, argv, "threads", to_string(numOfThreads)));
+    intraQueryThreadNumber = stoi(getOption(argc, argv, "intra", to_string(intraQueryThreadNumber)));
+    answerOutput = getOption(argc, argv, "output", answerOutput);
+    writeTrace = getOption(argc, argv, "trace", writeTrace ? "on" : "off")=="on";
+    answerType = getOption(argc, argv, "answer", answerType);
+    tagUndetermined = getOption(argc, argv, "tag", tagUndetermined ? "on" : "off")=="on";
+    batchQueries = getOption(argc, argv, "batch", batchQueries ? "on" : "off")=="on";
+    vertexOrder = getOption(argc, argv, "order", vertexOrder);
+    bottomUpBFS = getOption(argc, argv, "bottomup", bottomUpBFS ? "on" : "off")=="on";
+    resultCacheSize = stoull(getOption(argc, argv, "cache", to_string(resultCacheSize)));
+    landmarkNumber = stoi(getOption(argc, argv, "landmarks", to_string(landmarkNumber)));
+    if (answerType!="exact" && answerType!="upperbound") {
+        printf("! Unknown answer type: %s\n", answerType.c_str());
+        exit(1);
+    }
+
+    // server mode, keeping graph and EVE workers resident
+    if (string(argv[2])=="--server") {
+        string socketPath = getOption(argc, argv, "socket", "");
+
+        // responses own stdout when serving standard input, other outputs go to stderr
+        int responseFd = STDOUT_FILENO;
+        if (socketPath.empty()) {
+            responseFd = dup(STDOUT_FILENO);
+            dup2(STDERR_FILENO, STDOUT_FILENO);
+        }
+        Graph* graph = new Graph(("../"+datasetPath+graphFilename).c_str());
+        graph->reorderVertices(vertexOrder);
+
+        // with updates, the graph is copied to a dynamic graph compacted in background
+        DynamicGraph* dynamicGraph = NULL;
+        if (getOption(argc, argv, "updates", "off")=="on") {
+            if (landmarkNumber>0) {
+                printf("! Landmark index is not supported with updates\n");
+                exit(1);
+            }
+            dynamicGraph = new DynamicGraph(graph);
+            graph->cleanUp();
+            dynamicGraph->startCompaction(stoi(getOption(argc, argv, "compaction", "1000")));
+        }
+        Server* server = dynamicGraph!=NULL ? new Server(dynamicGraph) : new Server(graph);
+        if (socketPath.empty())
+            server->serveStream(STDIN_FILENO, responseFd);
+        else
+            server->serveSocket(socketPath.c_str());
+        server->cleanUp();
+        if (dynamicGraph!=NULL)
+            dynamicGraph->cleanUp();
+        return 0;
+    }
 
     // basic logs
     logFile.open("../"+logPath, ios::app);
@@ -20,10 +73,15 @@ int main(int argc, char *argv[]) {
 
     // initialize the graph
     Graph* graph = new Graph(("../"+datasetPath+graphFilename).c_str());
+    graph->reorderVertices(vertexOrder);
 
-    // initialize the queries
+    // initialize the queries, in new ids of reordered vertices
     vector<PerQuery> queries;
     loadQueries(("../"+datasetPath+queryFilename).c_str(), queries);
+    for (PerQuery& query : queries) {
+        query.source = graph->getNewId(query.source);
+        query.target = graph->getNewId(query.target);
+    }
     
     // EVE
     EVE* method = new EVE(graph);
@@ -32,4 +90,3 @@ int main(int argc, char *argv[]) {
 
     return 0;
 }
-
@@ -0,0 +1,123 @@
+#ifndef SCHEDULER_CC
+#define SCHEDULER_CC
+#include "Scheduler.h"
+using namespace std;
+
+
+
+Scheduler::Scheduler(size_t inputTaskNumber, int inputWorkerNumber, function<void(size_t)> inputWriteTask) {
+    taskNumber = inputTaskNumber;
+    workerNumber = inputWorkerNumber;
+    writeTask = inputWriteTask;
+
+    // split tasks evenly as initial ranges of workers
+    rangeBegin = new size_t[workerNumber];
+    rangeEnd = new size_t[workerNumber];
+    rangeLocks = new mutex[workerNumber];
+    for (int i=0; i<workerNumber; i++) {
+        rangeBegin[i] = taskNumber*i/workerNumber;
+        rangeEnd[i] = taskNumber*(i+1)/workerNumber;
+    }
+
+    // nothing written at beginning
+    isFinished = new bool[taskNumber]();
+    nextTaskToWrite = 0;
+}
+
+
+
+// take next task of a worker from the front of its own range
+bool Scheduler::getTask(int workerId, size_t& taskId) {
+    {
+        lock_guard<mutex> lock(rangeLocks[workerId]);
+        if (rangeBegin[workerId]<rangeEnd[workerId]) {
+            taskId = rangeBegin[workerId];
+            rangeBegin[workerId]++;
+            return true;
+        }
+    }
+    return stealTask(workerId, taskId);
+}
+
+
+
+// steal half of the remaining tasks from the back of the most loaded worker
+bool Scheduler::stealTask(int workerId, size_t& taskId) {
+    while (true) {
+
+        // find the victim with most remaining tasks, the ranges may change during scanning
+        int victim = -1;
+        size_t maxRemaining = 0;
+        for (int i=1; i<workerNumber; i++) {
+            int j = (workerId+i)%workerNumber;
+            lock_guard<mutex> lock(rangeLocks[j]);
+            if (rangeEnd[j]-rangeBegin[j]>maxRemaining) {
+                maxRemaining = rangeEnd[j]-rangeBegin[j];
+                victim = j;
+            }
+        }
+        if (victim<0)
+            return false;
+
+        // cut the back half of victim's range
+        size_t stolenBegin, stolenEnd;
+        {
+            lock_guard<mutex> lock(rangeLocks[victim]);
+            size_t remaining = rangeEnd[victim]-rangeBegin[victim];
+            if (remaining==0)
+                continue;
+            stolenEnd = rangeEnd[victim];
+            stolenBegin = stolenEnd-(remaining+1)/2;
+            rangeEnd[victim] = stolenBegin;
+        }
+
+        // run the first stolen task, keep the rest as own range
+        lock_guard<mutex> lock(rangeLocks[workerId]);
+        taskId = stolenBegin;
+        rangeBegin[workerId] = stolenBegin+1;
+        rangeEnd[workerId] = stolenEnd;
+        return true;
+    }
+}
+
+
+
+// mark a task finished and write all finished tasks in input order
+void Scheduler::finishTask(size_t taskId) {
+    {
+        lock_guard<mutex> lock(stateLock);
+        isFinished[taskId] = true;
+    }
+
+    // only one worker writes at a time, others go back to work
+    while (canWriteNextTask() && writeLock.try_lock()) {
+        while (canWriteNextTask()) {
+            writeTask(nextTaskToWrite);
+            lock_guard<mutex> lock(stateLock);
+            nextTaskToWrite++;
+        }
+        writeLock.unlock();
+    }
+}
+
+
+
+// whether the next task in input order is finished
+bool Scheduler::canWriteNextTask() {
+    lock_guard<mutex> lock(stateLock);
+    return nextTaskToWrite<taskNumber && isFinished[nextTaskToWrite];
+}
+
+
+
+// clean up memories allocated
+void Scheduler::cleanUp() {
+    delete[] rangeBegin;
+    delete[] rangeEnd;
+    delete[] rangeLocks;
+    delete[] isFinished;
+}
+
+
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+#include "../../GraphUtils/Utils.h"
+
+
+
+class Scheduler {
+
+    public:
+
+        Scheduler(size_t inputTaskNumber, int inputWorkerNumber, function<void(size_t)> inputWriteTask);
+        bool getTask(int workerId, size_t& taskId);                        // take next task of a worker, steal from others if its own range is empty
+        void finishTask(size_t taskId);                                     // mark a task finished and write finished tasks in input order
+        void cleanUp();
+
+    private:
+
+        // tasks are ids in [0, taskNumber), each worker owns a range [rangeBegin, rangeEnd)
+        size_t taskNumber;
+        int workerNumber;
+        size_t *rangeBegin, *rangeEnd;
+        mutex* rangeLocks;
+        bool stealTask(int workerId, size_t& taskId);
+
+        // write finished tasks in input order
+        function<void(size_t)> writeTask;
+        bool* isFinished;
+        size_t nextTaskToWrite;
+        mutex stateLock, writeLock;
+        bool canWriteNextTask();
+};
+
+
+
+#endif
@@ -0,0 +1,280 @@
+#ifndef SERVER_CC
+#define SERVER_CC
+#include "Server.h"
+#include <signal.h>
+using namespace std;
+
+
+
+Server::Server(Graph* inputGraph) {
+    graph = inputGraph;
+    dynamicGraph = NULL;
+    resultCache = NULL;
+
+    // index rejecting queries without path of k hops
+    landmarkIndex = NULL;
+    if (landmarkNumber>0) {
+        landmarkIndex = new LandmarkIndex(graph, landmarkNumber);
+        printf("Index with %d landmarks built in %.2f ms, index size: %.2f MB\n", landmarkIndex->landmarkNumber, landmarkIndex->buildTime, landmarkIndex->getSize()/1048576.0);
+    }
+
+    // a closed connection should not kill the server
+    signal(SIGPIPE, SIG_IGN);
+}
+
+
+
+Server::Server(DynamicGraph* inputDynamicGraph) {
+    dynamicGraph = inputDynamicGraph;
+    graph = &dynamicGraph->graph;
+    resultCache = NULL;
+    landmarkIndex = NULL;
+
+    // a closed connection should not kill the server
+    signal(SIGPIPE, SIG_IGN);
+}
+
+
+
+// serve requests from one stream, e.g., stdin and stdout
+void Server::serveStream(int inputFd, int outputFd) {
+    if (workers.size()==0)
+        workers.push_back(newWorker());
+    workers[0]->intraQueryThreads = getIntraQueryThreadNumber(1);
+    FILE* input = fdopen(inputFd, "r");
+    FILE* output = fdopen(outputFd, "w");
+    if (input==NULL || output==NULL) {
+        printf("! Cannot open input or output stream\n");
+        exit(1);
+    }
+    printf("Serving on standard input and output ...\n");
+    fflush(stdout);
+    serveConnection(workers[0], input, output);
+    fclose(input);
+    fclose(output);
+}
+
+
+
+// serve connections of a Unix domain socket, each thread owns an EVE worker and accepts connections in turn
+void Server::serveSocket(const char* socketPath) {
+
+    // listen on socket path
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(socketPath)>=sizeof(address.sun_path)) {
+        printf("! Socket path is too long: %s\n", socketPath);
+        exit(1);
+    }
+    strcpy(address.sun_path, socketPath);
+    int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(socketPath);
+    if (listenFd<0 || bind(listenFd, (sockaddr*)&address, sizeof(address))<0 || listen(listenFd, SOMAXCONN)<0) {
+        printf("! Cannot listen on socket %s\n", socketPath);
+        exit(1);
+    }
+
+    // workers with preallocated memory
+    int threadNumber = getThreadNumber();
+    while ((int)workers.size()<threadNumber)
+        workers.push_back(newWorker());
+    for (EVE* worker : workers)
+        worker->intraQueryThreads = getIntraQueryThreadNumber(threadNumber);
+    printf("Serving on socket %s with %d threads ...\n", socketPath, threadNumber);
+    fflush(stdout);
+
+    // each thread answers one connection at a time
+    auto acceptConnections = [this, listenFd](int workerId) {
+        while (true) {
+            int connectionFd = accept(listenFd, NULL, NULL);
+            if (connectionFd<0) {
+                if (errno==EINTR || errno==ECONNABORTED)
+                    continue;
+                printf("! Cannot accept connection on socket\n");
+                exit(1);
+            }
+            FILE* input = fdopen(connectionFd, "r");
+            FILE* output = fdopen(dup(connectionFd), "w");
+            serveConnection(workers[workerId], input, output);
+            fclose(input);
+            fclose(output);
+        }
+    };
+    vector<thread> threads;
+    for (int i=1; i<threadNumber; i++)
+        threads.push_back(thread(acceptConnections, i));
+    acceptConnections(0);
+}
+
+
+
+// EVE worker with preallocated memory, sharing the result cache
+EVE* Server::newWorker() {
+    EVE* worker = new EVE(graph);
+    if (resultCache==NULL && resultCacheSize>0 && !(worker->isUpperboundAnswer && tagUndetermined))
+        resultCache = new ResultCache(resultCacheSize<<20, !worker->isUpperboundAnswer);
+    worker->resultCache = resultCache;
+    worker->landmarkIndex = landmarkIndex;
+    return worker;
+}
+
+
+
+// answer requests of one connection until end of input
+void Server::serveConnection(EVE* worker, FILE* input, FILE* output) {
+    char* line = NULL;
+    size_t lineCapacity = 0;
+    PerQuery query;
+    short k;
+    string error, response;
+    vector<EdgeID> answer, undeterminedEdges;
+    while (getline(&line, &lineCapacity, input)!=-1) {
+
+        // skip empty lines
+        if (line[0]=='\n' || line[0]=='\r' || line[0]=='\0')
+            continue;
+
+        // insert or delete an edge
+        if (dynamicGraph!=NULL && (line[0]=='+' || line[0]=='-')) {
+            parseUpdate(line, response);
+
+        // answer with "number of edges,edge ids" as in answer file
+        } else if (parseRequest(line, query, k, error)) {
+            if (dynamicGraph!=NULL)
+                dynamicGraph->lockForQuery();
+            if (worker->isUpperboundAnswer && tagUndetermined)
+                worker->answerQuery(query.source, query.target, k, answer, undeterminedEdges);
+            else
+                worker->answerQuery(query.source, query.target, k, answer);
+            if (dynamicGraph!=NULL)
+                dynamicGraph->unlockForQuery();
+            response = to_string(answer.size());
+            for (EdgeID& edgeId : answer)
+                response += ","+to_string(edgeId);
+
+            // followed by a line of undetermined edges if tagging upperbound answers
+            if (worker->isUpperboundAnswer && tagUndetermined) {
+                response += "\n"+to_string(undeterminedEdges.size());
+                for (EdgeID& edgeId : undeterminedEdges)
+                    response += ","+to_string(edgeId);
+            }
+        } else
+            response = "! "+error;
+        response += "\n";
+        fwrite(response.c_str(), 1, response.length(), output);
+        if (fflush(output)!=0)
+            break;
+    }
+    free(line);
+}
+
+
+
+// parse a request line "source,target[,k]"
+bool Server::parseRequest(char* line, PerQuery& query, short& k, string& error) {
+    unsigned long long numbers[3];
+    int numberCount = parseNumbers(line, numbers, 3);
+    if (numberCount<2) {
+        error = "Request should be source,target[,k]";
+        return false;
+    }
+    if (numbers[0]>=graph->VN || numbers[1]>=graph->VN) {
+        error = "Vertex id should be smaller than "+to_string(graph->VN);
+        return false;
+    }
+    if (numberCount==3 && (numbers[2]<1 || numbers[2]>(unsigned long long)kMax)) {
+        error = "Hop constraint k should be in [1, "+to_string(kMax)+"]";
+        return false;
+    }
+    query.source = graph->getNewId(numbers[0]);
+    query.target = graph->getNewId(numbers[1]);
+    k = numberCount==3 ? numbers[2] : maxLen;
+    return true;
+}
+
+
+
+// apply an update line "+source,target" or "-edge id", the response is the edge id or an error
+bool Server::parseUpdate(char* line, string& response) {
+    unsigned long long numbers[2];
+    int numberCount = parseNumbers(line+1, numbers, 2);
+    EdgeID edgeId;
+
+    // answers cached before the update are dropped before any query sees the updated graph
+    function<void()> clearCache = nullptr;
+    if (resultCache)
+        clearCache = [this]() { resultCache->clear(); };
+    if (line[0]=='+') {
+        if (numberCount!=2) {
+            response = "! Insertion should be +source,target";
+            return false;
+        }
+        if (numbers[0]>=graph->VN || numbers[1]>=graph->VN || !dynamicGraph->insertEdge(graph->getNewId(numbers[0]), graph->getNewId(numbers[1]), edgeId, clearCache)) {
+            response = "! Vertex id should be smaller than "+to_string(graph->VN);
+            return false;
+        }
+    } else {
+        if (numberCount!=1) {
+            response = "! Deletion should be -edge id";
+            return false;
+        }
+        edgeId = numbers[0];
+        if (numbers[0]!=edgeId || !dynamicGraph->deleteEdge(edgeId, clearCache)) {
+            response = "! No edge "+to_string(numbers[0]);
+            return false;
+        }
+    }
+    response = to_string(edgeId);
+    return true;
+}
+
+
+
+// parse comma separated numbers of a line, return -1 if the line has anything else
+int Server::parseNumbers(char* line, unsigned long long* numbers, int maxNumberCount) {
+    int numberCount = 0;
+    char* current = line;
+    while (numberCount<maxNumberCount) {
+        while (*current==' ' || *current=='\t')
+            current++;
+        if (*current<'0' || *current>'9')
+            break;
+        char* end;
+        numbers[numberCount++] = strtoull(current, &end, 10);
+        current = end;
+        while (*current==' ' || *current=='\t')
+            current++;
+        if (*current!=',')
+            break;
+        current++;
+    }
+    if (*current!='\n' && *current!='\r' && *current!='\0')
+        return -1;
+    return numberCount;
+}
+
+
+
+// clean up workers and result cache
+void Server::cleanUp() {
+    for (EVE* worker : workers) {
+        worker->cleanUp();
+        delete worker;
+    }
+    workers.clear();
+    if (resultCache) {
+        printf("- Result cache: %llu hits, %llu misses, hit rate %.2f%%\n", resultCache->hits, resultCache->misses, resultCache->getHitRate()*100);
+        delete resultCache;
+        resultCache = NULL;
+    }
+    if (landmarkIndex) {
+        landmarkIndex->cleanUp();
+        delete landmarkIndex;
+        landmarkIndex = NULL;
+    }
+}
+
+
+
+#endif
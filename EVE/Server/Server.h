@@ -0,0 +1,46 @@
+#ifndef SERVER_H
+#define SERVER_H
+#include "../EVE.cc"
+#include "../../GraphUtils/DynamicGraph.cc"
+#include <sys/socket.h>
+#include <sys/un.h>
+
+
+
+/*
+Long-running server answering ad-hoc queries on a resident graph.
+Each request is a line "source,target" or "source,target,k" (k<=kMax), the same as a line of query file.
+Each response is a line "number of edges,edge ids" as in answer file, or a line starting with "!" for errors.
+If tagging upperbound answers, each response is followed by a line "number of edges,edge ids" of its undetermined edges.
+On a dynamic graph, a request "+source,target" inserts an edge and "-edge id" deletes an edge, the response is the edge id.
+*/
+class Server {
+
+    public:
+
+        Server(Graph* inputGraph);
+        Server(DynamicGraph* inputDynamicGraph);                            // also serve updates, queries read the graph with a lock
+        void serveStream(int inputFd, int outputFd);                        // serve requests from one stream, e.g., stdin and stdout
+        void serveSocket(const char* socketPath);                           // serve connections of a Unix domain socket, one worker per thread
+        void cleanUp();
+
+    private:
+
+        // graph and EVE workers with preallocated memory
+        Graph* graph;
+        DynamicGraph* dynamicGraph;                                         // NULL if the graph is static
+        vector<EVE*> workers;
+        ResultCache* resultCache;                                           // NULL if not caching, cleared by each update
+        LandmarkIndex* landmarkIndex;                                       // NULL if no index, only for a static graph
+        EVE* newWorker();
+
+        // answer requests of one connection until end of input
+        void serveConnection(EVE* worker, FILE* input, FILE* output);
+        bool parseRequest(char* line, PerQuery& query, short& k, string& error);
+        bool parseUpdate(char* line, string& response);                     // apply "+source,target" or "-edge id"
+        int parseNumbers(char* line, unsigned long long* numbers, int maxNumberCount);  // return -1 if not a line of numbers
+};
+
+
+
+#endif
@@ -5,10 +5,30 @@ using namespace std;
 
 
 
-Verification::Verification(Graph* inputGraph, VertexID* inputResults, int* inputIsInResult) {
+Verification::Verification(Graph* inputGraph, VertexID* inputResults, Epoch* inputIsInResult, Epoch* inputForwardDist, Epoch* inputBackwardDist, 
+                           VertexID* inputFrontier, VertexID* inputNextFrontier) {
 
     // basic graph information
     graph = inputGraph;
+    loadGraph();
+
+    // initialization
+    results = inputResults;
+    isInResult = inputIsInResult;
+    forwardDist = inputForwardDist;
+    backwardDist = inputBackwardDist;
+    frontier = inputFrontier;
+    nextFrontier = inputNextFrontier;
+    offset = 0;
+    maxLen = kMax;
+    trace = NULL;
+    initVerification();
+}
+
+
+
+// basic graph information, reloaded when arrays of a dynamic graph are moved
+void Verification::loadGraph() {
     VN = graph->VN;
     EN = graph->EN;
     edges = graph->edges;
@@ -16,21 +36,19 @@ Verification::Verification(Graph* inputGraph, VertexID* inputResults, int* input
     inNeighbors = graph->inNeighbors;
     outNeighborsLocator = graph->outNeighborsLocator;
     outNeighbors = graph->outNeighbors;
-
-    // initialization
-    results = inputResults;
-    isInResult = inputIsInResult;
-    initVerification();
 }
 
 
 
 // verification for undetermined edges 
-VertexID Verification::verifyUndeterminedEdge(VertexID& inputResultEnd, EdgeID& inputEdgesForVerificationEnd, 
+VertexID Verification::verifyUndeterminedEdge(Epoch inputOffset, short k, VertexID& inputResultEnd, EdgeID& inputEdgesForVerificationEnd, 
                                               VertexID& inputVerticesHavingOutNeighborsEnd, VertexID& inputVerticesHavingInNeighborsEnd, 
                                               VertexID& inputDeparturesEnd, VertexID& inputArrivalsEnd) {
     
     // obtain information from upper-bound graph
+    offset = inputOffset;
+    maxLen = k;
+    specialize<minSpecializedK>(k);
     resultEnd = inputResultEnd;
     edgesForVerificationEnd = inputEdgesForVerificationEnd;
     verticesHavingOutNeighborsEnd = inputVerticesHavingOutNeighborsEnd;
@@ -43,66 +61,150 @@ VertexID Verification::verifyUndeterminedEdge(VertexID& inputResultEnd, EdgeID&
         useSearchOrderingStrategy = true;
         BFS();
         reOrderingNeighbors();
+        if (trace)
+            trace->useSearchOrderingStrategy = true;
     } else 
         useSearchOrderingStrategy = false;
 
-    // iterate each undetermined edges
-    for (EdgeID i=0; i<edgesForVerificationEnd; i++) {
-        EdgeID& edgeId = edgesForVerification[i];
-        if (isInResult[edgeId]==offset)
-            continue;
-
-        // initialization for DFS
-        curFromId = edges[edgeId].fromId;
-        curToId = edges[edgeId].toId;
-        curPath[0] = edgeId;
-        curPathEnd = 1;
-        inStack[curToId] = true;
-        inStack[curFromId] = true;
-        
-        // if current edge links a departure
-        if (isDeparture[curFromId]==offset) {
-            departure = curFromId;
-
-            // if it also links an arrival
-            if (isArrival[curToId]==offset) {
-                arrival = curToId;
-                if (tryAddEdges()) {
-                    inStack[curToId] = false;
-                    inStack[curFromId] = false;
-                    continue;
-                }
-            }
+    // slots of dead ends for vertices in upper-bound graph
+    useDeadEnds = maxLen>6 && maxLen-3<=maxDeadEndDepth;
+    if (useDeadEnds) {
+        for (VertexID i=0; i<verticesHavingOutNeighborsEnd; i++)
+            forwardDeadEndSlots[verticesHavingOutNeighbors[i]] = i;
+        for (VertexID i=0; i<verticesHavingInNeighborsEnd; i++)
+            backwardDeadEndSlots[verticesHavingInNeighbors[i]] = i;
+    }
 
-            // if it does not link an arrival, search forward
-            if (maxLen>5 && forwardFinalSearch(curToId)) {
-                inStack[curToId] = false;
-                inStack[curFromId] = false;
-                continue;
-            }
+    // iterate each undetermined edges, by threads of the query if there are many
+    for (DFSStack& stack : stacks)
+        stack.forwardDFSNodes = stack.backwardDFSNodes = stack.deadEndHits = 0;
+    if (intraQueryThreads>1 && edgesForVerificationEnd>=parallelVerificationThreshold) {
+        while ((int)stacks.size()<intraQueryThreads)
+            stacks.push_back(newStack());
+        for (int threadId=0; threadId<intraQueryThreads; threadId++)
+            prepareDeadEnds(stacks[threadId]);
+        isParallel = true;
+        parallelForChunks(edgesForVerificationEnd, intraQueryThreads, parallelVerificationChunkSize, [this](int threadId, size_t begin, size_t end) {
+            for (size_t i=begin; i<end; i++)
+                (this->*specializedVerifyEdge)(stacks[threadId], edgesForVerification[i]);
+        });
+        isParallel = false;
+    } else {
+        prepareDeadEnds(stacks[0]);
+        for (EdgeID i=0; i<edgesForVerificationEnd; i++)
+            (this->*specializedVerifyEdge)(stacks[0], edgesForVerification[i]);
+    }
+
+    // statistics
+    if (trace)
+        for (DFSStack& stack : stacks) {
+            trace->forwardDFSNodes += stack.forwardDFSNodes;
+            trace->backwardDFSNodes += stack.backwardDFSNodes;
+            trace->deadEndHits += stack.deadEndHits;
         }
+    return resultEnd;
+}
+
+
 
-        // if current edge links an arrival, search backward
-        if (maxLen>5 && isArrival[curToId]==offset) {
-            arrival = curToId;
-            if (backwardFinalSearch(curFromId)) {
-                inStack[curToId] = false;
-                inStack[curFromId] = false;
-                continue;
+// verify an undetermined edge with a stack, skipping it if already added to results by a path of other edges
+template<short K> void Verification::verifyEdge(DFSStack& stack, EdgeID& edgeId) {
+    if (__atomic_load_n(isInResult+edgeId, __ATOMIC_RELAXED)==offset)
+        return;
+
+    // initialization for DFS
+    VertexID& curFromId = stack.curFromId;
+    VertexID& curToId = stack.curToId;
+    short* inStack = stack.inStack;
+    curFromId = edges[edgeId].fromId;
+    curToId = edges[edgeId].toId;
+    stack.curPath[0] = edgeId;
+    stack.curPathEnd = 1;
+    inStack[curFromId] = 1;
+    inStack[curToId] = 2;
+    stack.pushIds[1] = ++stack.pushCount;
+    stack.pushIds[2] = ++stack.pushCount;
+    stack.blockedDepths = 0;
+    
+    // if current edge links a departure
+    if (isDeparture[curFromId]==offset) {
+        stack.departure = curFromId;
+
+        // if it also links an arrival
+        if (isArrival[curToId]==offset) {
+            stack.arrival = curToId;
+            if (tryAddEdges<K>(stack)) {
+                inStack[curToId] = 0;
+                inStack[curFromId] = 0;
+                return;
             }
         }
-        
-        // decide to search forward or backward first by number of neighbors in each direction
-        if (maxLen>6) {
-            if (prunedOutNeighborsEnd[curToId]-outNeighborsLocator[curToId]<=prunedInNeighborsEnd[curFromId]-inNeighborsLocator[curFromId])
-                forwardSearch(curToId);
-            else    
-                backwardSearch(curFromId);
+
+        // if it does not link an arrival, search forward
+        if (getMaxLen<K>()>5 && forwardFinalSearch<K>(stack, curToId)) {
+            inStack[curToId] = 0;
+            inStack[curFromId] = 0;
+            return;
+        }
+    }
+
+    // if current edge links an arrival, search backward
+    if (getMaxLen<K>()>5 && isArrival[curToId]==offset) {
+        stack.arrival = curToId;
+        if (backwardFinalSearch<K>(stack, curFromId)) {
+            inStack[curToId] = 0;
+            inStack[curFromId] = 0;
+            return;
         }
-        inStack[curToId] = false;
-        inStack[curFromId] = false;
     }
-    return resultEnd;
+    
+    // decide to search forward or backward first by number of neighbors in each direction
+    if (getMaxLen<K>()>6) {
+        if (prunedOutNeighborsEnd[curToId]-outNeighborsLocator[curToId]<=prunedInNeighborsEnd[curFromId]-inNeighborsLocator[curFromId])
+            forwardSearch<K>(stack, curToId);
+        else    
+            backwardSearch<K>(stack, curFromId);
+    }
+    inStack[curToId] = 0;
+    inStack[curFromId] = 0;
+}
+
+
+
+// searches specialized for k if minSpecializedK<=k<=maxSpecializedK, otherwise the generic ones (K=0)
+template<short K> void Verification::specialize(short k) {
+    if (K==0 || k==K) {
+        specializedVerifyEdge = &Verification::verifyEdge<K>;
+        return;
+    }
+    specialize<(K==0 || K>=maxSpecializedK ? 0 : K+1)>(k);
+}
+
+
+
+// DFS stack of a thread
+Verification::DFSStack Verification::newStack() {
+    DFSStack stack;
+    stack.inStack = new short[VN]();
+    stack.curPath = new EdgeID[kMax-4];
+    stack.curPathEnd = 0;
+    stack.pushIds = new unsigned long long[kMax-2]();
+    stack.pushCount = 0;
+    stack.blockedDepths = 0;
+    stack.forwardDFSNodes = stack.backwardDFSNodes = stack.deadEndHits = 0;
+    return stack;
+}
+
+
+
+// dead ends of a stack for all vertices in upper-bound graph, new ones are not valid in any query
+void Verification::prepareDeadEnds(DFSStack& stack) {
+    if (!useDeadEnds)
+        return;
+    if (stack.forwardDeadEnds.size()<verticesHavingOutNeighborsEnd)
+        stack.forwardDeadEnds.resize(verticesHavingOutNeighborsEnd);
+    if (stack.backwardDeadEnds.size()<verticesHavingInNeighborsEnd)
+        stack.backwardDeadEnds.resize(verticesHavingInNeighborsEnd);
 }
 
 
@@ -115,34 +217,40 @@ void Verification::initVerification() {
     prunedInNeighbors = new PerNeighbor[EN];
     prunedOutNeighborsEnd = new EdgeID[VN];
     prunedInNeighborsEnd = new EdgeID[VN];
-    hasPrunedOutNeighbors = new int[VN]();
-    hasPrunedInNeighbors = new int[VN]();
+    hasPrunedOutNeighbors = new Epoch[VN]();
+    hasPrunedInNeighbors = new Epoch[VN]();
 
     // departures, arrivals and their neighbors
     departures = new VertexID[VN];
     arrivals = new VertexID[VN];
-    InD = new VertexID[VN*(maxLen-2)];
-    OutA = new VertexID[VN*(maxLen-2)];
+    InD = new VertexID[VN*(kMax-2)];
+    OutA = new VertexID[VN*(kMax-2)];
     InDEnds = new short[VN];
     OutAEnds = new short[VN];
-    isDeparture = new int[VN]();
-    isArrival = new int[VN]();
+    isDeparture = new Epoch[VN]();
+    isArrival = new Epoch[VN]();
 
     // edges to be verified
     edgesForVerification = new EdgeID[EN];
 
     // DFS search
-    inStack = new bool[VN]();
-    curPath = new EdgeID[maxLen-4];
-    InC = new VertexID[2];
-    OutC = new VertexID[2];
+    stacks.push_back(newStack());
+    intraQueryThreads = 1;
+    isParallel = false;
 
     // for search ordering strategy
-    if (maxLen>6) {
+    if (kMax>6) {
         verticesHavingInNeighbors = new VertexID[VN];
         verticesHavingOutNeighbors = new VertexID[VN];
-        forwardVisited = new int[VN]();
-        backwardVisited = new int[VN]();
+        forwardVisited = new Epoch[VN]();
+        backwardVisited = new Epoch[VN]();
+    }
+
+    // slots of dead ends
+    useDeadEnds = false;
+    if (kMax>6) {
+        forwardDeadEndSlots = new VertexID[VN];
+        backwardDeadEndSlots = new VertexID[VN];
     }
 }
 
@@ -157,8 +265,8 @@ double Verification::getCurrentSpaceCost() {
     spaceCost += 0;                                                     // prunedInNeighbors will be calculated in EVE.getCurrentSpaceCost()
     spaceCost += sizeof(EdgeID)*VN;                                     // prunedOutNeighborsEnd = new EdgeID[VN];
     spaceCost += sizeof(EdgeID)*VN;                                     // prunedInNeighborsEnd = new EdgeID[VN];
-    spaceCost += sizeof(int)*VN;                                        // hasPrunedOutNeighbors = new int[VN]();
-    spaceCost += sizeof(int)*VN;                                        // hasPrunedInNeighbors = new int[VN]();
+    spaceCost += sizeof(Epoch)*VN;                                      // hasPrunedOutNeighbors = new Epoch[VN]();
+    spaceCost += sizeof(Epoch)*VN;                                      // hasPrunedInNeighbors = new Epoch[VN]();
 
     // departures, arrivals and their neighbors
     spaceCost += sizeof(VertexID)*departuresEnd;                        // departures = new VertexID[VN];
@@ -167,24 +275,28 @@ double Verification::getCurrentSpaceCost() {
     spaceCost += 0;                                                     // OutA will be calculated in EVE.getCurrentSpaceCost()
     spaceCost += sizeof(short)*VN;                                      // InDEnds = new short[VN];
     spaceCost += sizeof(short)*VN;                                      // OutAEnds = new short[VN];
-    spaceCost += sizeof(int)*VN;                                        // isDeparture = new int[VN]();
-    spaceCost += sizeof(int)*VN;                                        // isArrival = new int[VN]();
+    spaceCost += sizeof(Epoch)*VN;                                      // isDeparture = new Epoch[VN]();
+    spaceCost += sizeof(Epoch)*VN;                                      // isArrival = new Epoch[VN]();
 
     // edges to be verified
     spaceCost += sizeof(EdgeID)*edgesForVerificationEnd;                // edgesForVerification = new EdgeID[EN];
 
     // DFS search
-    spaceCost += sizeof(bool)*VN;                                       // inStack = new bool[VN]();
-    spaceCost += sizeof(EdgeID)*(maxLen-4);                             // curPath = new EdgeID[maxLen-4];
-    spaceCost += sizeof(VertexID)*2;                                    // InC = new VertexID[2];
-    spaceCost += sizeof(VertexID)*2;                                    // OutC = new VertexID[2];
+    spaceCost += sizeof(short)*VN*stacks.size();                        // stack.inStack = new short[VN]();
+    spaceCost += sizeof(EdgeID)*(kMax-4)*stacks.size();                 // stack.curPath = new EdgeID[kMax-4];
+    spaceCost += sizeof(DFSStack)*stacks.size();                        // stacks of threads
+    spaceCost += sizeof(unsigned long long)*(kMax-2)*stacks.size();     // stack.pushIds = new unsigned long long[kMax-2]();
+    for (DFSStack& stack : stacks)
+        spaceCost += sizeof(DeadEnd)*(stack.forwardDeadEnds.capacity()+stack.backwardDeadEnds.capacity());     // dead ends of vertices in upper-bound graph
 
     // for search ordering strategy
-    if (maxLen>6) {
+    if (kMax>6) {
         spaceCost += sizeof(VertexID)*verticesHavingInNeighborsEnd;     // verticesHavingInNeighbors = new VertexID[VN];
         spaceCost += sizeof(VertexID)*verticesHavingOutNeighborsEnd;    // verticesHavingOutNeighbors = new VertexID[VN];
-        spaceCost += sizeof(int)*VN;                                    // forwardVisited = new int[VN]();
-        spaceCost += sizeof(int)*VN;                                    // backwardVisited = new int[VN]();
+        spaceCost += sizeof(Epoch)*VN;                                  // forwardVisited = new Epoch[VN]();
+        spaceCost += sizeof(Epoch)*VN;                                  // backwardVisited = new Epoch[VN]();
+        spaceCost += sizeof(VertexID)*VN;                               // forwardDeadEndSlots = new VertexID[VN];
+        spaceCost += sizeof(VertexID)*VN;                               // backwardDeadEndSlots = new VertexID[VN];
     }
 
     return spaceCost;
@@ -193,14 +305,19 @@ double Verification::getCurrentSpaceCost() {
 
 
 // refresh memory for new query
+// clear stamps when offset restarts from 0, while each query only refreshes the offset
 void Verification::refreshMemory() {
-    memset(isDeparture, 0, sizeof(int)*VN);
-    memset(isArrival, 0, sizeof(int)*VN);
-    memset(hasPrunedOutNeighbors, 0, sizeof(int)*VN);
-    memset(hasPrunedInNeighbors, 0, sizeof(int)*VN);
-    if (maxLen>6) {
-        memset(forwardVisited, 0, sizeof(int)*VN);
-        memset(backwardVisited, 0, sizeof(int)*VN);
+    memset(isDeparture, 0, sizeof(Epoch)*VN);
+    memset(isArrival, 0, sizeof(Epoch)*VN);
+    memset(hasPrunedOutNeighbors, 0, sizeof(Epoch)*VN);
+    memset(hasPrunedInNeighbors, 0, sizeof(Epoch)*VN);
+    if (kMax>6) {
+        memset(forwardVisited, 0, sizeof(Epoch)*VN);
+        memset(backwardVisited, 0, sizeof(Epoch)*VN);
+    }
+    for (DFSStack& stack : stacks) {
+        memset(stack.forwardDeadEnds.data(), 0, sizeof(DeadEnd)*stack.forwardDeadEnds.size());
+        memset(stack.backwardDeadEnds.data(), 0, sizeof(DeadEnd)*stack.backwardDeadEnds.size());
     }
 }
 
@@ -223,16 +340,20 @@ void Verification::cleanUp() {
     delete[] isDeparture;
     delete[] isArrival;
     delete[] edgesForVerification;
-    if (maxLen>6) {
+    if (kMax>6) {
         delete[] verticesHavingInNeighbors;
         delete[] verticesHavingOutNeighbors;
         delete[] forwardVisited;
         delete[] backwardVisited;
+        delete[] forwardDeadEndSlots;
+        delete[] backwardDeadEndSlots;
+    }
+    for (DFSStack& stack : stacks) {
+        delete[] stack.inStack;
+        delete[] stack.curPath;
+        delete[] stack.pushIds;
     }
-    delete[] inStack;
-    delete[] curPath;
-    delete[] InC;
-    delete[] OutC;
+    stacks.clear();
 }
 
 
@@ -240,9 +361,6 @@ void Verification::cleanUp() {
 // BFS search from departures and arrivals
 void Verification::BFS() {
 
-    // initialization
-    frontier = forwardFrontier;
-
     // forward BFS from departures
     frontierEnd = 0;
     for (VertexID i=0; i<departuresEnd; i++) {
@@ -334,7 +452,7 @@ void Verification::reOrderingNeighbors() {
         VertexID& u = verticesHavingOutNeighbors[i];
         EdgeID& uStart = outNeighborsLocator[u];
         EdgeID& uEnd = prunedOutNeighborsEnd[u];
-        sort(prunedOutNeighbors+uStart, prunedOutNeighbors+uEnd, sortByArrivals);
+        sort(prunedOutNeighbors+uStart, prunedOutNeighbors+uEnd, SortByArrivals(this));
 
         // remove edges can not reach any arrivals
         while (uEnd>uStart) {
@@ -349,7 +467,7 @@ void Verification::reOrderingNeighbors() {
         VertexID& u = verticesHavingInNeighbors[i];
         EdgeID& uStart = inNeighborsLocator[u];
         EdgeID& uEnd = prunedInNeighborsEnd[u];
-        sort(prunedInNeighbors+uStart, prunedInNeighbors+uEnd, sortByDepartures);
+        sort(prunedInNeighbors+uStart, prunedInNeighbors+uEnd, SortByDepartures(this));
 
         // remove edges can not be reached by any departures
         while (uEnd>uStart) {
@@ -362,41 +480,75 @@ void Verification::reOrderingNeighbors() {
 
 
 
+// order pruned in-neighbors by distance from departures
+bool Verification::SortByDepartures::operator()(const PerNeighbor& a, const PerNeighbor& b) const {
+    Epoch* forwardVisited = verification->forwardVisited;
+    Epoch* forwardDist = verification->forwardDist;
+    Epoch& offset = verification->offset;
+    if (forwardVisited[a.neighbor]==offset && forwardVisited[b.neighbor]==offset) {
+        if (forwardDist[a.neighbor]==0 && forwardDist[b.neighbor]==0)
+            return verification->InDEnds[a.neighbor]>verification->InDEnds[b.neighbor];
+        return forwardDist[a.neighbor]<forwardDist[b.neighbor];
+    }
+    return forwardVisited[a.neighbor]==offset;
+}
+
+
+
+// order pruned out-neighbors by distance to arrivals
+bool Verification::SortByArrivals::operator()(const PerNeighbor& a, const PerNeighbor& b) const {
+    Epoch* backwardVisited = verification->backwardVisited;
+    Epoch* backwardDist = verification->backwardDist;
+    Epoch& offset = verification->offset;
+    if (backwardVisited[a.neighbor]==offset && backwardVisited[b.neighbor]==offset) {
+        if (backwardDist[a.neighbor]==0 && backwardDist[b.neighbor]==0)
+            return verification->OutAEnds[a.neighbor]>verification->OutAEnds[b.neighbor];
+        return backwardDist[a.neighbor]<backwardDist[b.neighbor];
+    }
+    return backwardVisited[a.neighbor]==offset;
+}
+
+
+
 // search forward when no departure specified
-bool Verification::forwardSearch(VertexID& u) {
+template<short K> bool Verification::forwardSearch(DFSStack& stack, VertexID& u) {
     bool ans = false;
+    if (trace)
+        stack.forwardDFSNodes++;
 
     // iterate each out edge u->v
     if (hasPrunedOutNeighbors[u]==offset)
         for (EdgeID outEdgeLocation=outNeighborsLocator[u]; outEdgeLocation<prunedOutNeighborsEnd[u]; outEdgeLocation++) {
             VertexID& v = prunedOutNeighbors[outEdgeLocation].neighbor;
-            if (useSearchOrderingStrategy && curPathEnd+1+backwardDist[v]+1>maxLen-4)
+            if (useSearchOrderingStrategy && stack.curPathEnd+1+backwardDist[v]+1>getMaxLen<K>()-4)
                 break;
 
             // if next vertex not in stack
-            if (inStack[v]==false) {
+            if (stack.inStack[v]==0) {
                 EdgeID& edgeId = prunedOutNeighbors[outEdgeLocation].edgeId; 
-                curPath[curPathEnd] = edgeId;
-                curPathEnd++;
-                inStack[v] = true;
+                stack.curPath[stack.curPathEnd] = edgeId;
+                stack.curPathEnd++;
+                stack.inStack[v] = stack.curPathEnd+1;
+                stack.pushIds[stack.curPathEnd+1] = ++stack.pushCount;
 
                 // if reach an arrival, start search backward
                 if (isArrival[v]==offset) {
-                    arrival = v;
-                    if (backwardFinalSearch(curFromId))
+                    stack.arrival = v;
+                    if (backwardFinalSearch<K>(stack, stack.curFromId))
                         ans = true;
                 }
                 
                 // continue forward search
-                if (ans==false && curPathEnd+2<=maxLen-4 && forwardSearch(v)) 
+                if (ans==false && stack.curPathEnd+2<=getMaxLen<K>()-4 && forwardSearch<K>(stack, v)) 
                     ans = true;
 
                 // pop edge e(u,v) and vertex v from stacks
-                curPathEnd--;
-                inStack[v] = false;
+                stack.curPathEnd--;
+                stack.inStack[v] = 0;
                 if (ans)
                     return true;                
-            }
+            } else
+                stack.blockedDepths |= 1ULL<<(stack.inStack[v]&63);         // skipped for a vertex in stack
         }
     return false;
 }
@@ -404,81 +556,99 @@ bool Verification::forwardSearch(VertexID& u) {
 
 
 // search backward given specified arrival
-bool Verification::backwardFinalSearch(VertexID& u) {
+template<short K> bool Verification::backwardFinalSearch(DFSStack& stack, VertexID& u) {
     bool ans = false;
+    DeadEnd* deadEnd = useDeadEnds && hasPrunedInNeighbors[u]==offset ? &stack.backwardDeadEnds[backwardDeadEndSlots[u]] : NULL;
+    if (deadEnd!=NULL && isDeadEnd<K>(stack, *deadEnd, stack.arrival))
+        return false;
+    unsigned long long outerBlockedDepths = stack.blockedDepths;
+    stack.blockedDepths = 0;
+    if (trace)
+        stack.backwardDFSNodes++;
 
     // iterate each in edge v->u
     if (hasPrunedInNeighbors[u]==offset)
         for (EdgeID inEdgeLocation=inNeighborsLocator[u]; inEdgeLocation<prunedInNeighborsEnd[u]; inEdgeLocation++) {
             VertexID& v = prunedInNeighbors[inEdgeLocation].neighbor;
-            if (useSearchOrderingStrategy && curPathEnd+1+forwardDist[v]>maxLen-4)
+            if (useSearchOrderingStrategy && stack.curPathEnd+1+forwardDist[v]>getMaxLen<K>()-4)
                 break;
             
             // if next vertex not in stack
-            if (inStack[v]==false) {
+            if (stack.inStack[v]==0) {
                 EdgeID& edgeId = prunedInNeighbors[inEdgeLocation].edgeId; 
-                curPath[curPathEnd] = edgeId;
-                curPathEnd++;
-                inStack[v] = true;
+                stack.curPath[stack.curPathEnd] = edgeId;
+                stack.curPathEnd++;
+                stack.inStack[v] = stack.curPathEnd+1;
+                stack.pushIds[stack.curPathEnd+1] = ++stack.pushCount;
 
                 // if reach a departure, try add edges in stack to results
                 if (isDeparture[v]==offset) {
-                    departure = v;
-                    if (tryAddEdges())
+                    stack.departure = v;
+                    if (tryAddEdges<K>(stack))
                         ans = true;
                 }
                 
                 // continue backward search
-                if (ans==false && curPathEnd+1<=maxLen-4 && backwardFinalSearch(v))
+                if (ans==false && stack.curPathEnd+1<=getMaxLen<K>()-4 && backwardFinalSearch<K>(stack, v))
                     ans = true;
                 
                 // pop edge e(v,u) and vertex v from stacks
-                curPathEnd--;
-                inStack[v] = false;
+                stack.curPathEnd--;
+                stack.inStack[v] = 0;
                 if (ans)
                     return true;
-            }
+            } else
+                stack.blockedDepths |= 1ULL<<(stack.inStack[v]&63);         // skipped for a vertex in stack
         }
+
+    // no path from u within the budget, given the arrival and vertices in stack
+    if (deadEnd!=NULL)
+        addDeadEnd<K>(stack, *deadEnd, u, stack.arrival);
+    stack.blockedDepths |= outerBlockedDepths;
     return false;
 }
 
 
 
 // search backward when no departure specified
-bool Verification::backwardSearch(VertexID& u) {
+template<short K> bool Verification::backwardSearch(DFSStack& stack, VertexID& u) {
     bool ans = false;
+    if (trace)
+        stack.backwardDFSNodes++;
 
     // iterate each in edge v->u
     if (hasPrunedInNeighbors[u]==offset)
         for (EdgeID inEdgeLocation=inNeighborsLocator[u]; inEdgeLocation<prunedInNeighborsEnd[u]; inEdgeLocation++) {
             VertexID& v = prunedInNeighbors[inEdgeLocation].neighbor;
-            if (useSearchOrderingStrategy && curPathEnd+1+forwardDist[v]+1>maxLen-4)
+            if (useSearchOrderingStrategy && stack.curPathEnd+1+forwardDist[v]+1>getMaxLen<K>()-4)
                 break;
             
             // if next vertex not in stack
-            if (inStack[v]==false) {
+            if (stack.inStack[v]==0) {
                 EdgeID& edgeId = prunedInNeighbors[inEdgeLocation].edgeId; 
-                curPath[curPathEnd] = edgeId;
-                curPathEnd++;
-                inStack[v] = true;
+                stack.curPath[stack.curPathEnd] = edgeId;
+                stack.curPathEnd++;
+                stack.inStack[v] = stack.curPathEnd+1;
+                stack.pushIds[stack.curPathEnd+1] = ++stack.pushCount;
 
                 // if reach a departure, start forward search
                 if (isDeparture[v]==offset) {
-                    departure = v;
-                    if (forwardFinalSearch(curToId))
+                    stack.departure = v;
+                    if (forwardFinalSearch<K>(stack, stack.curToId))
                         ans = true;
                 }
                 
                 // continue backward search
-                if (ans==false && curPathEnd+2<=maxLen-4 && backwardSearch(v))
+                if (ans==false && stack.curPathEnd+2<=getMaxLen<K>()-4 && backwardSearch<K>(stack, v))
                     ans = true;
                 
                 // pop edge e(v,u) and vertex v from stacks
-                curPathEnd--;
-                inStack[v] = false;
+                stack.curPathEnd--;
+                stack.inStack[v] = 0;
                 if (ans)
                     return true;
-            }
+            } else
+                stack.blockedDepths |= 1ULL<<(stack.inStack[v]&63);         // skipped for a vertex in stack
         }
     return false;
 }
@@ -486,81 +656,124 @@ bool Verification::backwardSearch(VertexID& u) {
 
 
 // search forward given specified departure
-bool Verification::forwardFinalSearch(VertexID& u) {
+template<short K> bool Verification::forwardFinalSearch(DFSStack& stack, VertexID& u) {
     bool ans = false;
+    DeadEnd* deadEnd = useDeadEnds && hasPrunedOutNeighbors[u]==offset ? &stack.forwardDeadEnds[forwardDeadEndSlots[u]] : NULL;
+    if (deadEnd!=NULL && isDeadEnd<K>(stack, *deadEnd, stack.departure))
+        return false;
+    unsigned long long outerBlockedDepths = stack.blockedDepths;
+    stack.blockedDepths = 0;
+    if (trace)
+        stack.forwardDFSNodes++;
 
     // iterate each out edge u->v
     if (hasPrunedOutNeighbors[u]==offset)
         for (EdgeID outEdgeLocation=outNeighborsLocator[u]; outEdgeLocation<prunedOutNeighborsEnd[u]; outEdgeLocation++) {
             VertexID& v = prunedOutNeighbors[outEdgeLocation].neighbor;
-            if (useSearchOrderingStrategy && curPathEnd+1+backwardDist[v]>maxLen-4)
+            if (useSearchOrderingStrategy && stack.curPathEnd+1+backwardDist[v]>getMaxLen<K>()-4)
                 break;
 
             // if next vertex not in stack
-            if (inStack[v]==false) {
+            if (stack.inStack[v]==0) {
                 EdgeID& edgeId = prunedOutNeighbors[outEdgeLocation].edgeId; 
-                curPath[curPathEnd] = edgeId;
-                curPathEnd++;
-                inStack[v] = true;
+                stack.curPath[stack.curPathEnd] = edgeId;
+                stack.curPathEnd++;
+                stack.inStack[v] = stack.curPathEnd+1;
+                stack.pushIds[stack.curPathEnd+1] = ++stack.pushCount;
 
                 // if reach an arrival, try add edges in stack to results 
                 if (isArrival[v]==offset) {
-                    arrival = v;
-                    if (tryAddEdges())
+                    stack.arrival = v;
+                    if (tryAddEdges<K>(stack))
                         ans = true;
                 }
                 
                 // continue forward search
-                if (ans==false && curPathEnd+1<=maxLen-4 && forwardFinalSearch(v))
+                if (ans==false && stack.curPathEnd+1<=getMaxLen<K>()-4 && forwardFinalSearch<K>(stack, v))
                     ans = true;
 
                 // pop edge e(u,v) and vertex v from stacks
-                curPathEnd--;
-                inStack[v] = false;
+                stack.curPathEnd--;
+                stack.inStack[v] = 0;
                 if (ans)
                     return true;
-            }
+            } else
+                stack.blockedDepths |= 1ULL<<(stack.inStack[v]&63);         // skipped for a vertex in stack
         }
 
+
+    // no path from u within the budget, given the departure and vertices in stack
+    if (deadEnd!=NULL)
+        addDeadEnd<K>(stack, *deadEnd, u, stack.departure);
+    stack.blockedDepths |= outerBlockedDepths;
     return false;
 }
 
 
 
+// whether the final search from u fails as a former one, with the same departure (or arrival) and no more budget
+// the former failure holds while stack keeps the push at the deepest depth of vertices in stack it skipped, as more vertices in stack only block more paths
+template<short K> inline bool Verification::isDeadEnd(DFSStack& stack, DeadEnd& deadEnd, VertexID context) {
+    if (deadEnd.stamp!=offset || deadEnd.context!=context || getMaxLen<K>()-4-(short)stack.curPathEnd>deadEnd.budget)
+        return false;
+    if (deadEnd.blockedDepths!=0 && stack.pushIds[63-__builtin_clzll(deadEnd.blockedDepths)]!=deadEnd.pushId)
+        return false;
+    stack.blockedDepths |= deadEnd.blockedDepths;
+    if (trace)
+        stack.deadEndHits++;
+    return true;
+}
+
+
+
+// record failure of the final search from u, depending on vertices in stack skipped by the search except u itself
+template<short K> inline void Verification::addDeadEnd(DFSStack& stack, DeadEnd& deadEnd, VertexID& u, VertexID context) {
+    unsigned long long blockedDepths = stack.blockedDepths & ((2ULL<<(stack.curPathEnd+1))-1) & ~(1ULL<<stack.inStack[u]);
+    deadEnd.stamp = offset;
+    deadEnd.context = context;
+    deadEnd.budget = getMaxLen<K>()-4-stack.curPathEnd;
+    deadEnd.blockedDepths = blockedDepths;
+    deadEnd.pushId = blockedDepths==0 ? 0 : stack.pushIds[63-__builtin_clzll(blockedDepths)];
+}
+
+
+
 // try add edges in current stack to results
-bool Verification::tryAddEdges() {
-    if (InDEnds[departure]+OutAEnds[arrival]>=2*maxLen-5) {
-        addToResults();
+template<short K> bool Verification::tryAddEdges(DFSStack& stack) {
+    if (InDEnds[stack.departure]+OutAEnds[stack.arrival]>=2*getMaxLen<K>()-5) {
+        addToResults(stack);
         return true;
     }
 
     // obtain In_C
     short InCEnd = 0;
-    for (short i=0; i<InDEnds[departure]; i++) {
-        VertexID& a = InD[departure*(maxLen-2)+i];
-        if (inStack[a]==false && InCEnd<2) {
-            InC[InCEnd] = a;
+    for (short i=0; i<InDEnds[stack.departure]; i++) {
+        VertexID& a = InD[stack.departure*(kMax-2)+i];
+        if (stack.inStack[a]==0 && InCEnd<2) {
+            stack.InC[InCEnd] = a;
             InCEnd++;
-        }
+        } else if (stack.inStack[a]>0)
+            stack.blockedDepths |= 1ULL<<(stack.inStack[a]&63);
     }
     if (InCEnd==0)
         return false;
 
     // obtain Out_C
     short OutCEnd = 0;
-    for (short j=0; j<OutAEnds[arrival]; j++) {
-        VertexID& b = OutA[arrival*(maxLen-2)+j];
-        if (inStack[b]==false && OutCEnd<2) {
-            OutC[OutCEnd] = b;
+    for (short j=0; j<OutAEnds[stack.arrival]; j++) {
+        VertexID& b = OutA[stack.arrival*(kMax-2)+j];
+        if (stack.inStack[b]==0 && OutCEnd<2) {
+            stack.OutC[OutCEnd] = b;
             OutCEnd++;
-        }
+        } else if (stack.inStack[b]>0)
+            stack.blockedDepths |= 1ULL<<(stack.inStack[b]&63);
     }
     if (OutCEnd==0)
         return false;
 
     // add to results
-    if (InCEnd+OutCEnd>2 || InC[0]!=OutC[0]) {
-        addToResults();
+    if (InCEnd+OutCEnd>2 || stack.InC[0]!=stack.OutC[0]) {
+        addToResults(stack);
         return true;
     }
     return false;
@@ -569,12 +782,17 @@ bool Verification::tryAddEdges() {
 
 
 // add edges in current path to final results
-void Verification::addToResults() {
-    for (VertexID k=0; k<curPathEnd; k++)
-        if (isInResult[curPath[k]]<offset) {
-            results[resultEnd] = curPath[k];
+// threads claim each edge by compare-and-swap of its stamp, so that it is added once and other threads skip it as soon as possible
+void Verification::addToResults(DFSStack& stack) {
+    for (VertexID k=0; k<stack.curPathEnd; k++)
+        if (isParallel) {
+            Epoch stamp = __atomic_load_n(isInResult+stack.curPath[k], __ATOMIC_RELAXED);
+            if (stamp<offset && __sync_bool_compare_and_swap(isInResult+stack.curPath[k], stamp, offset))
+                results[__sync_fetch_and_add(&resultEnd, 1)] = stack.curPath[k];
+        } else if (isInResult[stack.curPath[k]]<offset) {
+            results[resultEnd] = stack.curPath[k];
             resultEnd++;
-            isInResult[curPath[k]] = offset;
+            isInResult[stack.curPath[k]] = offset;
         }
 }
 
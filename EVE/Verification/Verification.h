@@ -1,6 +1,7 @@
 #ifndef VERIFICATION_H
 #define VERIFICATION_H
 #include "../../GraphUtils/Graph.cc"
+#include "../QueryTrace/QueryTrace.cc"
 
 
 
@@ -8,25 +9,35 @@ class Verification {
 
     public:
 
-        Verification(Graph* inputGraph, VertexID* inputResults, int* inputIsInResult);
-        VertexID verifyUndeterminedEdge(VertexID& inputResultEnd, EdgeID& inputEdgesForVerificationEnd, 
+        Verification(Graph* inputGraph, VertexID* inputResults, Epoch* inputIsInResult, Epoch* inputForwardDist, Epoch* inputBackwardDist, 
+                     VertexID* inputFrontier, VertexID* inputNextFrontier);
+        VertexID verifyUndeterminedEdge(Epoch inputOffset, short k, VertexID& inputResultEnd, EdgeID& inputEdgesForVerificationEnd, 
                                         VertexID& inputDeparturesEnd, VertexID& inputArrivalsEnd, 
                                         VertexID& inputVerticesHavingOutNeighborsEnd, VertexID& inputVerticesHavingInNeighborsEnd);
         double getCurrentSpaceCost();
 
         // results
-        int* isInResult;
+        Epoch* isInResult;
         VertexID resultEnd;
 
+        // counters of current query, recorded only if not NULL
+        QueryTrace* trace;
+
+        // threads verifying undetermined edges of a query, see parallelVerificationThreshold
+        int intraQueryThreads;
+
         // refresh and clean up memories
         void refreshMemory();
         void cleanUp();
+        void loadGraph();                                                   // reload arrays of graph moved by updates, |E| not changed
 
         // departures, arrivals and their neighbors
-        VertexID *InD, *OutA, *departures, departuresEnd, *arrivals, arrivalsEnd, departure, arrival;
+        VertexID *InD, *OutA, *departures, departuresEnd, *arrivals, arrivalsEnd;
+        short *InDEnds, *OutAEnds;
+        Epoch *isDeparture, *isArrival;
 
         // for storing neighbors in upper-bound graph
-        int *hasPrunedInNeighbors, *hasPrunedOutNeighbors;
+        Epoch *hasPrunedInNeighbors, *hasPrunedOutNeighbors;
         PerNeighbor *prunedInNeighbors, *prunedOutNeighbors;
         EdgeID *prunedInNeighborsEnd, *prunedOutNeighborsEnd;
 
@@ -43,27 +54,75 @@ class Verification {
         VertexID VN;                                                        // |V| of graph
         EdgeID EN;                                                          // |E| of graph
         PerEdge* edges;                                                     // store all edges in graph
-        PerNeighbor *outNeighbors, *inNeighbors;                            // neighbors of each vertex, length=EN
+        VertexID *outNeighbors, *inNeighbors;                               // ids of neighbors of each vertex, length=EN
         EdgeID *outNeighborsLocator, *inNeighborsLocator;                   // locate where to find the neighbors of a vertex, length=VN
 
+        // epoch and hop constraint of current query, shared with EVE
+        Epoch offset;
+        short maxLen;
+
         // BFS search from departures and arrivals and sort pruned neighbors
-        VertexID *frontier, frontierEnd;
+        VertexID *frontier, frontierEnd, *nextFrontier, nextFrontierEnd;
+        Epoch *forwardDist, *backwardDist, *forwardVisited, *backwardVisited;
         bool useSearchOrderingStrategy;
         void BFS();
         void reOrderingNeighbors();
 
-        // DFS search
-        EdgeID* curPath;                                                    // record edges in current DFS path
-        VertexID curFromId, curToId, curPathEnd=0;
-        VertexID *results, *InC, *OutC;
-        
-        bool *inStack;
-        bool forwardSearch(VertexID& u);
-        bool backwardSearch(VertexID& u);
-        bool forwardFinalSearch(VertexID& u);
-        bool backwardFinalSearch(VertexID& u);
-        bool tryAddEdges();
-        void addToResults();
+        // for sorting neighbors (search ordering strategy)
+        struct SortByDepartures {
+            Verification* verification;
+            SortByDepartures(Verification* v): verification(v) {}
+            bool operator()(const PerNeighbor& a, const PerNeighbor& b) const;
+        };
+        struct SortByArrivals {
+            Verification* verification;
+            SortByArrivals(Verification* v): verification(v) {}
+            bool operator()(const PerNeighbor& a, const PerNeighbor& b) const;
+        };
+
+        // failure of a final search from a vertex with a budget of edges, given the departure (or arrival) and vertices in stack
+        // it also fails with no more budget, as long as stack keeps the push at the deepest depth of blockedDepths
+        struct DeadEnd {
+            Epoch stamp;                                                    // valid in the query of offset
+            VertexID context;                                               // departure of forward search, or arrival of backward search
+            short budget;
+            unsigned long long blockedDepths, pushId;                       // depths of vertices in stack skipped by the search, and push id at the deepest one
+        };
+
+        // DFS search, each thread has its own stack while results are shared
+        struct DFSStack {
+            EdgeID* curPath;                                                // record edges in current DFS path
+            VertexID curFromId, curToId, curPathEnd, departure, arrival;
+            VertexID InC[2], OutC[2];
+            short* inStack;                                                 // depth of each vertex in stack (1 for curFromId, 2 for curToId), 0 if not in stack, length=VN
+            unsigned long long *pushIds, pushCount;                         // id of the push at each depth, unique in the stack
+            unsigned long long blockedDepths;                               // depths of vertices in stack skipped by current search
+            vector<DeadEnd> forwardDeadEnds, backwardDeadEnds;              // by slots of vertices in upper-bound graph, growing to the largest one
+            unsigned long long forwardDFSNodes, backwardDFSNodes, deadEndHits;  // merged into trace
+        };
+        vector<DFSStack> stacks;                                            // stacks[0] for a single thread
+        DFSStack newStack();
+        VertexID* results;
+        bool isParallel;                                                    // results are added by threads
+        template<short K> void verifyEdge(DFSStack& stack, EdgeID& edgeId);                 // K is maxLen known at compile time, or 0 for any maxLen
+        template<short K> bool forwardSearch(DFSStack& stack, VertexID& u);
+        template<short K> bool backwardSearch(DFSStack& stack, VertexID& u);
+        template<short K> bool forwardFinalSearch(DFSStack& stack, VertexID& u);
+        template<short K> bool backwardFinalSearch(DFSStack& stack, VertexID& u);
+        template<short K> bool tryAddEdges(DFSStack& stack);
+        void addToResults(DFSStack& stack);
+        template<short K> inline bool isDeadEnd(DFSStack& stack, DeadEnd& deadEnd, VertexID context);
+        template<short K> inline void addDeadEnd(DFSStack& stack, DeadEnd& deadEnd, VertexID& u, VertexID context);
+
+        // slots of dead ends shared by stacks, i.e., the index of a vertex in verticesHavingOutNeighbors (or verticesHavingInNeighbors)
+        bool useDeadEnds;                                                   // maxLen>6 and stack depths fit in blockedDepths
+        VertexID *forwardDeadEndSlots, *backwardDeadEndSlots;               // valid if the vertex has pruned out (or in) neighbors, length=VN
+        void prepareDeadEnds(DFSStack& stack);
+
+        // searches specialized for maxLen of current query, chosen once per query
+        void (Verification::*specializedVerifyEdge)(DFSStack& stack, EdgeID& edgeId);
+        template<short K> void specialize(short k);
+        template<short K> inline short getMaxLen() { return K>0 ? K : maxLen; }            // hop constraint in searches of K, a constant unless K=0
 
         // initialization
         void initVerification();
@@ -74,29 +133,12 @@ class Verification {
 // threshold for search ordering strategy
 EdgeID sortPrunedThreshold = 1024;
 
+// dead ends of final searches are kept for k>6 if depths of stack, up to k-3, fit in blockedDepths
+const short maxDeadEndDepth = 62;
 
-
-// for sorting neighbors (search ordering strategy)
-short *InDEnds, *OutAEnds;
-int *isDeparture, *isArrival, *forwardVisited, *backwardVisited;
-
-bool sortByDepartures(PerNeighbor& a, PerNeighbor& b) {
-    if (forwardVisited[a.neighbor]==offset && forwardVisited[b.neighbor]==offset) {
-        if (forwardDist[a.neighbor]==0 && forwardDist[b.neighbor]==0)
-            return InDEnds[a.neighbor]>InDEnds[b.neighbor];
-        return forwardDist[a.neighbor]<forwardDist[b.neighbor];
-    }
-    return forwardVisited[a.neighbor]==offset;
-}
-
-bool sortByArrivals(PerNeighbor& a, PerNeighbor& b) {
-    if (backwardVisited[a.neighbor]==offset && backwardVisited[b.neighbor]==offset) {
-        if (backwardDist[a.neighbor]==0 && backwardDist[b.neighbor]==0)
-            return OutAEnds[a.neighbor]>OutAEnds[b.neighbor];
-        return backwardDist[a.neighbor]<backwardDist[b.neighbor];
-    }
-    return backwardVisited[a.neighbor]==offset;
-}
+// threads verify undetermined edges of a query if there are as many, handing out chunks of parallelVerificationChunkSize
+EdgeID parallelVerificationThreshold = 256;
+size_t parallelVerificationChunkSize = 8;
 
 
 
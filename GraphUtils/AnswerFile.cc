@@ -0,0 +1,366 @@
+#ifndef ANSWERFILE_CC
+#define ANSWERFILE_CC
+#include "AnswerFile.h"
+using namespace std;
+
+
+
+AnswerWriter::AnswerWriter(string inputFormat, string outputPathWithoutSuffix) {
+    f = NULL;
+    buffer = NULL;
+    bufferEnd = 0;
+
+    // output format and suffix of answer file
+    string suffix;
+    if (inputFormat=="none") {
+        format = noAnswer;
+        return;
+    } else if (inputFormat=="text") {
+        format = textAnswer;
+        suffix = ".EVE.answer";
+    } else if (inputFormat=="binary") {
+        format = binaryAnswer;
+        suffix = ".EVE.answer.bin";
+    } else if (inputFormat=="zstd") {
+        #ifdef USE_ZSTD
+            format = zstdAnswer;
+            suffix = ".EVE.answer.bin.zst";
+        #else
+            printf("! Answer output zstd needs to build with ZSTD=1\n");
+            exit(1);
+        #endif
+    } else {
+        printf("! Unknown answer output: %s\n", inputFormat.c_str());
+        exit(1);
+    }
+
+    // open answer file
+    f = fopen((outputPathWithoutSuffix+suffix).c_str(), "wb");
+    if (f==NULL) {
+        printf("! Can not write answer file: %s\n", (outputPathWithoutSuffix+suffix).c_str());
+        exit(1);
+    }
+    buffer = new char[answerBufferSize];
+    #ifdef USE_ZSTD
+        if (format==zstdAnswer) {
+            compressContext = ZSTD_createCCtx();
+            compressedBufferSize = ZSTD_CStreamOutSize();
+            compressedBuffer = new char[compressedBufferSize];
+        }
+    #endif
+
+    // header
+    if (format==textAnswer) {
+        const char* header = "number of edges,edge ids\n";
+        bufferEnd = strlen(header);
+        memcpy(buffer, header, bufferEnd);
+    } else {
+        BinaryAnswerHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, binaryAnswerMagic, sizeof(header.magic));
+        header.version = binaryAnswerVersion;
+        header.edgeIdSize = sizeof(EdgeID);
+        bufferEnd = sizeof(header);
+        memcpy(buffer, &header, bufferEnd);
+    }
+}
+
+
+
+// write one answer of sorted edge ids
+void AnswerWriter::writeAnswer(vector<EdgeID>& answer) {
+    if (format==noAnswer)
+        return;
+
+    // "number of edges,edge ids" in text
+    if (format==textAnswer) {
+        reserve(24);
+        writeText(answer.size());
+        for (EdgeID& edgeId : answer) {
+            reserve(24);
+            buffer[bufferEnd++] = ',';
+            writeText(edgeId);
+        }
+        buffer[bufferEnd++] = '\n';
+
+    // number of edges and deltas of sorted edge ids in varint
+    } else {
+        reserve(10);
+        writeVarint(answer.size());
+        EdgeID lastEdgeId = 0;
+        for (EdgeID& edgeId : answer) {
+            reserve(10);
+            writeVarint(edgeId-lastEdgeId);
+            lastEdgeId = edgeId;
+        }
+    }
+}
+
+
+
+// make room for length bytes in buffer
+inline void AnswerWriter::reserve(size_t length) {
+    if (bufferEnd+length>answerBufferSize)
+        flush(false);
+}
+
+
+
+// decimal digits of value
+inline void AnswerWriter::writeText(unsigned long long value) {
+    char digits[20];
+    short digitsEnd = 0;
+    do {
+        digits[digitsEnd++] = '0'+value%10;
+        value /= 10;
+    } while (value>0);
+    while (digitsEnd>0)
+        buffer[bufferEnd++] = digits[--digitsEnd];
+}
+
+
+
+// 7 bits per byte, the highest bit is set if more bytes follow
+inline void AnswerWriter::writeVarint(unsigned long long value) {
+    while (value>=128) {
+        buffer[bufferEnd++] = (char)(value|128);
+        value >>= 7;
+    }
+    buffer[bufferEnd++] = (char)value;
+}
+
+
+
+// write buffer to file, compressed if needed
+void AnswerWriter::flush(bool isEnd) {
+    #ifdef USE_ZSTD
+        if (format==zstdAnswer) {
+            ZSTD_inBuffer input = {buffer, bufferEnd, 0};
+            size_t remaining;
+            do {
+                ZSTD_outBuffer output = {compressedBuffer, compressedBufferSize, 0};
+                remaining = ZSTD_compressStream2(compressContext, &output, &input, isEnd ? ZSTD_e_end : ZSTD_e_continue);
+                if (ZSTD_isError(remaining)) {
+                    printf("! Failed to compress answers: %s\n", ZSTD_getErrorName(remaining));
+                    exit(1);
+                }
+                fwrite(compressedBuffer, 1, output.pos, f);
+            } while (isEnd ? remaining>0 : input.pos<input.size);
+            bufferEnd = 0;
+            return;
+        }
+    #endif
+    fwrite(buffer, 1, bufferEnd, f);
+    bufferEnd = 0;
+}
+
+
+
+// flush and close answer file
+void AnswerWriter::close() {
+    if (format==noAnswer)
+        return;
+    flush(true);
+    fclose(f);
+    delete[] buffer;
+    #ifdef USE_ZSTD
+        if (format==zstdAnswer) {
+            ZSTD_freeCCtx(compressContext);
+            delete[] compressedBuffer;
+        }
+    #endif
+    format = noAnswer;
+}
+
+
+
+AnswerReader::AnswerReader(const char* inputFilename) {
+    f = fopen(inputFilename, "rb");
+    if (f==NULL) {
+        printf("! Can not open answer file: %s\n", inputFilename);
+        exit(1);
+    }
+    bufferSize = answerBufferSize;
+    buffer = new char[bufferSize];
+    isCompressed = false;
+    refill();
+
+    // zstd frames, decompress bytes already read at first
+    unsigned int magic = 0;
+    if (bufferEnd-bufferPos>=4)
+        memcpy(&magic, bufferPos, 4);
+    if (magic==zstdFrameMagic) {
+        #ifdef USE_ZSTD
+            isCompressed = true;
+            decompressContext = ZSTD_createDCtx();
+            compressedBufferSize = bufferSize;
+            compressedBuffer = new char[compressedBufferSize];
+            memcpy(compressedBuffer, bufferPos, bufferEnd-bufferPos);
+            compressedInput = {compressedBuffer, (size_t)(bufferEnd-bufferPos), 0};
+            bufferPos = bufferEnd = buffer;
+        #else
+            printf("! Reading zstd answer file needs to build with ZSTD=1\n");
+            exit(1);
+        #endif
+    }
+
+    // binary answers start with the magic, while text answers start with a header line
+    if (bufferPos==bufferEnd && !refill()) {
+        format = textAnswer;
+        return;
+    }
+    if (*bufferPos==binaryAnswerMagic[0]) {
+        format = isCompressed ? zstdAnswer : binaryAnswer;
+        BinaryAnswerHeader header;
+        char* headerBytes = (char*)&header;
+        for (size_t i=0; i<sizeof(header); i++) {
+            int c = nextByte();
+            if (c<0) {
+                printf("! Answer file is truncated: %s\n", inputFilename);
+                exit(1);
+            }
+            headerBytes[i] = c;
+        }
+        if (memcmp(header.magic, binaryAnswerMagic, sizeof(header.magic))!=0 || header.version!=binaryAnswerVersion) {
+            printf("! Unsupported binary answer file: %s\n", inputFilename);
+            exit(1);
+        }
+    } else {
+        format = textAnswer;
+        if (*bufferPos<'0' || *bufferPos>'9') {
+            int c;
+            do c = nextByte(); while (c>=0 && c!='\n');
+        }
+    }
+}
+
+
+
+// read one answer of sorted edge ids, return false at end of file
+bool AnswerReader::readAnswer(vector<EdgeID>& answer) {
+    answer.clear();
+    unsigned long long edgeNumber, value;
+
+    // "number of edges,edge ids" in text
+    if (format==textAnswer) {
+        int last;
+        if (!readNumber(edgeNumber, last))
+            return false;
+        for (unsigned long long i=0; i<edgeNumber; i++) {
+            if (last!=',' || !readNumber(value, last)) {
+                printf("! Answer file is truncated\n");
+                exit(1);
+            }
+            answer.push_back(value);
+        }
+        return true;
+    }
+
+    // number of edges and deltas of sorted edge ids in varint
+    if (!readVarint(edgeNumber))
+        return false;
+    EdgeID lastEdgeId = 0;
+    for (unsigned long long i=0; i<edgeNumber; i++) {
+        if (!readVarint(value)) {
+            printf("! Answer file is truncated\n");
+            exit(1);
+        }
+        lastEdgeId += value;
+        answer.push_back(lastEdgeId);
+    }
+    return true;
+}
+
+
+
+// next byte of (decompressed) file, -1 at end of file
+inline int AnswerReader::nextByte() {
+    if (bufferPos==bufferEnd && !refill())
+        return -1;
+    return (unsigned char)*bufferPos++;
+}
+
+
+
+// read next chunk of (decompressed) file into buffer
+bool AnswerReader::refill() {
+    bufferPos = bufferEnd = buffer;
+    #ifdef USE_ZSTD
+        if (isCompressed) {
+            while (true) {
+                if (compressedInput.pos==compressedInput.size) {
+                    size_t length = fread(compressedBuffer, 1, compressedBufferSize, f);
+                    if (length==0)
+                        return false;
+                    compressedInput = {compressedBuffer, length, 0};
+                }
+                ZSTD_outBuffer output = {buffer, bufferSize, 0};
+                size_t result = ZSTD_decompressStream(decompressContext, &output, &compressedInput);
+                if (ZSTD_isError(result)) {
+                    printf("! Failed to decompress answers: %s\n", ZSTD_getErrorName(result));
+                    exit(1);
+                }
+                if (output.pos>0) {
+                    bufferEnd = buffer+output.pos;
+                    return true;
+                }
+            }
+        }
+    #endif
+    bufferEnd = buffer+fread(buffer, 1, bufferSize, f);
+    return bufferEnd>buffer;
+}
+
+
+
+// read a varint, return false at end of file
+bool AnswerReader::readVarint(unsigned long long& value) {
+    value = 0;
+    for (short shift=0; shift<64; shift+=7) {
+        int c = nextByte();
+        if (c<0)
+            return false;
+        value |= (unsigned long long)(c&127)<<shift;
+        if (c<128)
+            return true;
+    }
+    return false;
+}
+
+
+
+// read a decimal number and the byte after it, return false at end of file
+bool AnswerReader::readNumber(unsigned long long& value, int& last) {
+    value = 0;
+    int c = nextByte();
+    while (c=='\r' || c=='\n')
+        c = nextByte();
+    if (c<'0' || c>'9')
+        return false;
+    while (c>='0' && c<='9') {
+        value = value*10+c-'0';
+        c = nextByte();
+    }
+    if (c=='\r')
+        c = nextByte();
+    last = c;
+    return true;
+}
+
+
+
+// close answer file
+void AnswerReader::close() {
+    fclose(f);
+    delete[] buffer;
+    #ifdef USE_ZSTD
+        if (isCompressed) {
+            ZSTD_freeDCtx(decompressContext);
+            delete[] compressedBuffer;
+        }
+    #endif
+}
+
+
+
+#endif
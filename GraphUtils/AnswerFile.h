@@ -0,0 +1,97 @@
+#ifndef ANSWERFILE_H
+#define ANSWERFILE_H
+#include "Utils.h"
+#ifdef USE_ZSTD
+    #include <zstd.h>
+#endif
+
+
+
+/*
+Answer files, each answer is the sorted edge ids of one query.
+- text:   a header line, then a line "number of edges,edge ids" for each answer
+- binary: a header, then varint(number of edges) and varint deltas of sorted edge ids for each answer
+- zstd:   binary format compressed as zstd frames (only if compiled with USE_ZSTD)
+*/
+enum AnswerFormat {noAnswer, textAnswer, binaryAnswer, zstdAnswer};
+
+
+
+// buffered writer of answers without flushing for each answer
+class AnswerWriter {
+
+    public:
+
+        AnswerWriter(string inputFormat, string outputPathWithoutSuffix);
+        void writeAnswer(vector<EdgeID>& answer);
+        void close();
+        AnswerFormat format;
+
+    private:
+
+        FILE* f;
+        char* buffer;
+        size_t bufferEnd;
+        inline void reserve(size_t length);                                 // make room for length bytes in buffer
+        inline void writeText(unsigned long long value);
+        inline void writeVarint(unsigned long long value);
+        void flush(bool isEnd);
+
+        #ifdef USE_ZSTD
+            ZSTD_CCtx* compressContext;
+            char* compressedBuffer;
+            size_t compressedBufferSize;
+        #endif
+};
+
+
+
+// reader of answer files in any format, detected by the beginning of file
+class AnswerReader {
+
+    public:
+
+        AnswerReader(const char* inputFilename);
+        bool readAnswer(vector<EdgeID>& answer);                            // return false at end of file
+        void close();
+        AnswerFormat format;
+
+    private:
+
+        FILE* f;
+        char *buffer, *bufferPos, *bufferEnd;
+        size_t bufferSize;
+        bool isCompressed;
+        inline int nextByte();                                              // -1 at end of file
+        bool refill();
+        bool readVarint(unsigned long long& value);
+        bool readNumber(unsigned long long& value, int& last);
+
+        #ifdef USE_ZSTD
+            ZSTD_DCtx* decompressContext;
+            char* compressedBuffer;
+            ZSTD_inBuffer compressedInput;
+            size_t compressedBufferSize;
+        #endif
+};
+
+
+
+// header of binary answer file
+struct BinaryAnswerHeader {
+    char magic[8];                                                  // always "EVE-ANS"
+    unsigned int version;                                           // format version, see binaryAnswerVersion
+    unsigned int edgeIdSize;                                        // sizeof(EdgeID) when written
+};
+const char binaryAnswerMagic[8] = "EVE-ANS";
+const unsigned int binaryAnswerVersion = 1;
+
+// size of buffers for reading and writing answers
+const size_t answerBufferSize = 1<<20;
+
+// first 4 bytes of a zstd frame in little endian
+const unsigned int zstdFrameMagic = 0xFD2FB528;
+
+
+
+#endif
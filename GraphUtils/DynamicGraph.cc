@@ -0,0 +1,296 @@
+#ifndef DYNAMICGRAPH_CC
+#define DYNAMICGRAPH_CC
+#include "DynamicGraph.h"
+using namespace std;
+
+
+
+DynamicGraph::DynamicGraph(Graph* inputGraph) {
+
+    // edges keep their ids, with room for insertions
+    graph.VN = inputGraph->VN;
+    edgeEnd = liveEN = compactedEN = inputGraph->EN;
+    edgeCapacity = edgeEnd+edgeEnd*tailRoomRatio+minimumVertexRoom;
+    edges = new PerEdge[edgeCapacity];
+    memcpy(edges, inputGraph->edges, sizeof(PerEdge)*edgeEnd);
+    tombstones.assign(edgeEnd, false);
+
+    // ids of reordered vertices
+    if (inputGraph->newIds!=NULL) {
+        graph.newIds = new VertexID[graph.VN];
+        graph.originalIds = new VertexID[graph.VN];
+        memcpy(graph.newIds, inputGraph->newIds, sizeof(VertexID)*graph.VN);
+        memcpy(graph.originalIds, inputGraph->originalIds, sizeof(VertexID)*graph.VN);
+    }
+
+    // neighbors with room for each vertex
+    buildArrays(outArrays, inputGraph->outNeighbors, inputGraph->outNeighborEdgeIds, inputGraph->outNeighborsLocator, inputGraph->outNeighborsLocatorEnd);
+    buildArrays(inArrays, inputGraph->inNeighbors, inputGraph->inNeighborEdgeIds, inputGraph->inNeighborsLocator, inputGraph->inNeighborsLocatorEnd);
+    updateView();
+
+    // updates are not starved by a stream of queries
+    pthread_rwlockattr_t lockAttributes;
+    pthread_rwlockattr_init(&lockAttributes);
+    #ifdef __GLIBC__
+        pthread_rwlockattr_setkind_np(&lockAttributes, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+    #endif
+    pthread_rwlock_init(&queryLock, &lockAttributes);
+    pthread_rwlockattr_destroy(&lockAttributes);
+    isCompacting = false;
+}
+
+
+
+// insert edge fromId->toId with a new edge id, return false if vertices are out of range
+bool DynamicGraph::insertEdge(VertexID fromId, VertexID toId, EdgeID& edgeId, function<void()> onUpdate) {
+    if (fromId>=graph.VN || toId>=graph.VN)
+        return false;
+    lock_guard<mutex> updateLock(updateMutex);
+    pthread_rwlock_wrlock(&queryLock);
+
+    // edges grow by doubling, which moves the array
+    bool isMoved = false;
+    if (edgeEnd==edgeCapacity) {
+        edgeCapacity = edgeCapacity*2;
+        PerEdge* newEdges = new PerEdge[edgeCapacity];
+        memcpy(newEdges, edges, sizeof(PerEdge)*edgeEnd);
+        delete[] edges;
+        edges = newEdges;
+        isMoved = true;
+    }
+    edgeId = edgeEnd++;
+    edges[edgeId] = {edgeId, fromId, toId};
+    tombstones.push_back(false);
+    liveEN++;
+
+    // compact if the tail has no room for the moved neighbors
+    if (!insertNeighbor(outArrays, fromId, toId, edgeId)) {
+        rebuild(true);
+        insertNeighbor(outArrays, fromId, toId, edgeId);
+    }
+    if (!insertNeighbor(inArrays, toId, fromId, edgeId)) {
+        rebuild(true);
+        insertNeighbor(inArrays, toId, fromId, edgeId);
+    }
+    if (isMoved)
+        updateView();
+    if (onUpdate)
+        onUpdate();
+    pthread_rwlock_unlock(&queryLock);
+    return true;
+}
+
+
+
+// delete edge and tombstone its id, return false if no such edge or already deleted
+bool DynamicGraph::deleteEdge(EdgeID edgeId, function<void()> onUpdate) {
+    lock_guard<mutex> updateLock(updateMutex);
+    if (edgeId>=edgeEnd || tombstones[edgeId])
+        return false;
+    pthread_rwlock_wrlock(&queryLock);
+    PerEdge& edge = edges[edgeId];
+    deleteNeighbor(outArrays, edge.fromId, edge.toId, edgeId);
+    deleteNeighbor(inArrays, edge.toId, edge.fromId, edgeId);
+    tombstones[edgeId] = true;
+    liveEN--;
+    if (onUpdate)
+        onUpdate();
+    pthread_rwlock_unlock(&queryLock);
+    return true;
+}
+
+
+
+// rebuild arrays without garbage
+void DynamicGraph::compact() {
+    lock_guard<mutex> updateLock(updateMutex);
+    rebuild(false);
+}
+
+
+
+// compact every intervalInMs in a background thread, if the tail is half used or half of edges are deleted
+void DynamicGraph::startCompaction(int intervalInMs) {
+    if (isCompacting)
+        return;
+    isCompacting = true;
+    compactionThread = thread([this, intervalInMs]() {
+        unique_lock<mutex> compactionLock(compactionMutex);
+        while (!compactionCondition.wait_for(compactionLock, chrono::milliseconds(intervalInMs), [this]() { return !isCompacting; })) {
+            lock_guard<mutex> updateLock(updateMutex);
+            if (needsCompaction())
+                rebuild(false);
+        }
+    });
+}
+
+
+
+// stop background compaction
+void DynamicGraph::stopCompaction() {
+    if (!isCompacting)
+        return;
+    {
+        lock_guard<mutex> compactionLock(compactionMutex);
+        isCompacting = false;
+    }
+    compactionCondition.notify_all();
+    compactionThread.join();
+}
+
+
+
+// queries read graph between lockForQuery() and unlockForQuery()
+void DynamicGraph::lockForQuery() {
+    pthread_rwlock_rdlock(&queryLock);
+}
+
+
+
+void DynamicGraph::unlockForQuery() {
+    pthread_rwlock_unlock(&queryLock);
+}
+
+
+
+// copy neighbors[locator[u]:locatorEnd[u]] of each vertex with room for insertions, and leave a tail for moved vertices
+void DynamicGraph::buildArrays(NeighborArrays& arrays, VertexID* neighbors, EdgeID* edgeIds, EdgeID* locator, EdgeID* locatorEnd) {
+    VertexID& VN = graph.VN;
+    arrays.locator = new EdgeID[VN];
+    arrays.locatorEnd = new EdgeID[VN];
+    arrays.roomEnd = new EdgeID[VN];
+    EdgeID location = 0;
+    for (VertexID u=0; u<VN; u++) {
+        EdgeID degree = locatorEnd[u]-locator[u];
+        arrays.locator[u] = location;
+        arrays.locatorEnd[u] = location+degree;
+        location += degree+max(degree/4, minimumVertexRoom);
+        arrays.roomEnd[u] = location;
+    }
+    arrays.tailStart = arrays.tail = location;
+    arrays.size = location+location*tailRoomRatio+minimumVertexRoom;
+    arrays.neighbors = new VertexID[arrays.size];
+    arrays.edgeIds = new EdgeID[arrays.size];
+    for (VertexID u=0; u<VN; u++) {
+        memcpy(arrays.neighbors+arrays.locator[u], neighbors+locator[u], sizeof(VertexID)*(locatorEnd[u]-locator[u]));
+        memcpy(arrays.edgeIds+arrays.locator[u], edgeIds+locator[u], sizeof(EdgeID)*(locatorEnd[u]-locator[u]));
+    }
+}
+
+
+
+void DynamicGraph::freeArrays(NeighborArrays& arrays) {
+    delete[] arrays.neighbors;
+    delete[] arrays.edgeIds;
+    delete[] arrays.locator;
+    delete[] arrays.locatorEnd;
+    delete[] arrays.roomEnd;
+}
+
+
+
+// insert neighbor v of u in order of neighbor and edge id, return false if the vertex has no room and the tail is full
+bool DynamicGraph::insertNeighbor(NeighborArrays& arrays, VertexID u, VertexID v, EdgeID edgeId) {
+
+    // move neighbors to the tail with doubled room
+    if (arrays.locatorEnd[u]==arrays.roomEnd[u]) {
+        EdgeID degree = arrays.locatorEnd[u]-arrays.locator[u];
+        EdgeID room = max(degree*2, minimumVertexRoom);
+        if (arrays.tail+room>arrays.size)
+            return false;
+        memcpy(arrays.neighbors+arrays.tail, arrays.neighbors+arrays.locator[u], sizeof(VertexID)*degree);
+        memcpy(arrays.edgeIds+arrays.tail, arrays.edgeIds+arrays.locator[u], sizeof(EdgeID)*degree);
+        arrays.locator[u] = arrays.tail;
+        arrays.locatorEnd[u] = arrays.tail+degree;
+        arrays.tail += room;
+        arrays.roomEnd[u] = arrays.tail;
+    }
+
+    // shift larger neighbors, the new edge id is larger than ids of the same neighbor
+    EdgeID neighborsEnd = arrays.locatorEnd[u];
+    EdgeID position = upper_bound(arrays.neighbors+arrays.locator[u], arrays.neighbors+neighborsEnd, v)-arrays.neighbors;
+    memmove(arrays.neighbors+position+1, arrays.neighbors+position, sizeof(VertexID)*(neighborsEnd-position));
+    memmove(arrays.edgeIds+position+1, arrays.edgeIds+position, sizeof(EdgeID)*(neighborsEnd-position));
+    arrays.neighbors[position] = v;
+    arrays.edgeIds[position] = edgeId;
+    arrays.locatorEnd[u]++;
+    return true;
+}
+
+
+
+// remove neighbor v of u by edge id and shift larger neighbors, its slot becomes room of the vertex
+void DynamicGraph::deleteNeighbor(NeighborArrays& arrays, VertexID u, VertexID v, EdgeID edgeId) {
+    EdgeID neighborsEnd = arrays.locatorEnd[u];
+    EdgeID position = lower_bound(arrays.neighbors+arrays.locator[u], arrays.neighbors+neighborsEnd, v)-arrays.neighbors;
+    while (arrays.edgeIds[position]!=edgeId)
+        position++;
+    memmove(arrays.neighbors+position, arrays.neighbors+position+1, sizeof(VertexID)*(neighborsEnd-position-1));
+    memmove(arrays.edgeIds+position, arrays.edgeIds+position+1, sizeof(EdgeID)*(neighborsEnd-position-1));
+    arrays.locatorEnd[u]--;
+}
+
+
+
+// the tail is half used or half of edges are deleted since last compaction
+bool DynamicGraph::needsCompaction() {
+    for (NeighborArrays* arrays : {&outArrays, &inArrays})
+        if ((arrays->tail-arrays->tailStart)*2>arrays->size-arrays->tailStart)
+            return true;
+    return liveEN*2<compactedEN;
+}
+
+
+
+// rebuild arrays while queries go on, then swap them with queries locked out unless already locked
+void DynamicGraph::rebuild(bool isQueryLocked) {
+    NeighborArrays oldOutArrays = outArrays, oldInArrays = inArrays;
+    NeighborArrays newOutArrays, newInArrays;
+    buildArrays(newOutArrays, outArrays.neighbors, outArrays.edgeIds, outArrays.locator, outArrays.locatorEnd);
+    buildArrays(newInArrays, inArrays.neighbors, inArrays.edgeIds, inArrays.locator, inArrays.locatorEnd);
+    if (!isQueryLocked)
+        pthread_rwlock_wrlock(&queryLock);
+    outArrays = newOutArrays;
+    inArrays = newInArrays;
+    compactedEN = liveEN;
+    updateView();
+    if (!isQueryLocked)
+        pthread_rwlock_unlock(&queryLock);
+    freeArrays(oldOutArrays);
+    freeArrays(oldInArrays);
+}
+
+
+
+// point the CSR view to current arrays, methods reload them by the new layout version
+// EN never shrinks, so that methods keep their buffers sized by EN after compaction
+void DynamicGraph::updateView() {
+    graph.EN = max(graph.EN, max(edgeCapacity, max(outArrays.size, inArrays.size)));
+    graph.edges = edges;
+    graph.outNeighbors = outArrays.neighbors;
+    graph.outNeighborEdgeIds = outArrays.edgeIds;
+    graph.outNeighborsLocator = outArrays.locator;
+    graph.outNeighborsLocatorEnd = outArrays.locatorEnd;
+    graph.inNeighbors = inArrays.neighbors;
+    graph.inNeighborEdgeIds = inArrays.edgeIds;
+    graph.inNeighborsLocator = inArrays.locator;
+    graph.inNeighborsLocatorEnd = inArrays.locatorEnd;
+    graph.layoutVersion++;
+}
+
+
+
+// stop compaction and free arrays, the view is not usable afterwards
+void DynamicGraph::cleanUp() {
+    stopCompaction();
+    freeArrays(outArrays);
+    freeArrays(inArrays);
+    delete[] edges;
+    delete[] graph.newIds;
+    delete[] graph.originalIds;
+    pthread_rwlock_destroy(&queryLock);
+}
+
+
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef DYNAMICGRAPH_H
+#define DYNAMICGRAPH_H
+#include "Graph.cc"
+
+
+
+/*
+Graph with edge insertions and deletions, queried through the same CSR arrays as Graph (see graph below).
+- Neighbors of each vertex are kept sorted in neighbors[locator[u]:locatorEnd[u]], with room up to roomEnd[u] for insertions.
+- A vertex without room moves its neighbors to the tail of the array with doubled room, the old room becomes garbage.
+- A deleted edge is removed from neighbors and its id is tombstoned, edge ids are never reused or changed.
+- Compaction rebuilds the arrays without garbage, either when the tail is full or periodically in background.
+Queries read the graph between lockForQuery() and unlockForQuery(), while updates and compaction lock it exclusively.
+Methods (e.g., EVE) reload the arrays when graph.layoutVersion changes, i.e., after compaction or growth of edges.
+*/
+class DynamicGraph {
+
+    public:
+
+        DynamicGraph(Graph* inputGraph);                        // copy of a static graph, which can be cleaned up afterwards
+        // onUpdate runs after an update while queries are still locked out, e.g., to drop answers cached before it
+        bool insertEdge(VertexID fromId, VertexID toId, EdgeID& edgeId, function<void()> onUpdate = nullptr);   // return false if vertices are out of range
+        bool deleteEdge(EdgeID edgeId, function<void()> onUpdate = nullptr);                                   // return false if no such edge or already deleted
+        void compact();
+        void startCompaction(int intervalInMs);                 // compact in a background thread if needed
+        void stopCompaction();
+        void lockForQuery();
+        void unlockForQuery();
+        void cleanUp();
+        Graph graph;                                            // CSR view of current arrays, EN is the bound of edge ids and neighbor locations
+        EdgeID liveEN;                                          // number of edges not deleted
+
+    private:
+
+        // neighbors of one direction, which can be moved by compaction
+        struct NeighborArrays {
+            VertexID* neighbors;
+            EdgeID* edgeIds;                                    // sharing locators with neighbors
+            EdgeID *locator, *locatorEnd, *roomEnd;             // length=VN
+            EdgeID size, tailStart, tail;                       // capacity, start of tail for moved vertices and start of its unused room
+        };
+        NeighborArrays outArrays, inArrays;
+        void buildArrays(NeighborArrays& arrays, VertexID* neighbors, EdgeID* edgeIds, EdgeID* locator, EdgeID* locatorEnd);
+        void freeArrays(NeighborArrays& arrays);
+        bool insertNeighbor(NeighborArrays& arrays, VertexID u, VertexID v, EdgeID edgeId);
+        void deleteNeighbor(NeighborArrays& arrays, VertexID u, VertexID v, EdgeID edgeId);
+        bool needsCompaction();
+        void rebuild(bool isQueryLocked);                       // compaction with updates locked
+        void updateView();
+
+        // edges by id, including tombstones
+        PerEdge* edges;
+        EdgeID edgeEnd, edgeCapacity;
+        EdgeID compactedEN;                                     // liveEN at last compaction
+        vector<bool> tombstones;
+
+        // queries hold queryLock for reading, updates hold updateMutex and queryLock for writing
+        pthread_rwlock_t queryLock;
+        mutex updateMutex;
+
+        // background compaction
+        thread compactionThread;
+        mutex compactionMutex;
+        condition_variable compactionCondition;
+        bool isCompacting;
+
+};
+
+// room of each vertex after compaction, and room of the tail for moved vertices
+const EdgeID minimumVertexRoom = 2;
+const double tailRoomRatio = 0.25;
+
+
+
+#endif
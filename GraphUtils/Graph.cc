@@ -6,7 +6,49 @@ using namespace std;
 
 Graph::Graph(const char* inputGraphFilename) {
     graphFilename = inputGraphFilename;
-    loadGraphFile();
+    mappedFile = NULL;
+    newIds = originalIds = NULL;
+    mappedSize = 0;
+    if (isBinaryGraphFile())
+        loadBinaryGraphFile();
+    else
+        loadGraphFile();
+    inNeighborsLocatorEnd = inNeighborsLocator+1;
+    outNeighborsLocatorEnd = outNeighborsLocator+1;
+    layoutVersion = 0;
+}
+
+
+
+Graph::Graph(VertexID inputVN, vector<pair<VertexID, VertexID>>& inputEdges) {
+    graphFilename = "";
+    mappedFile = NULL;
+    newIds = originalIds = NULL;
+    mappedSize = 0;
+    VN = inputVN;
+    EN = inputEdges.size();
+    edges = new PerEdge[EN];
+    for (EdgeID edgeId=0; edgeId<EN; edgeId++)
+        edges[edgeId] = {edgeId, inputEdges[edgeId].first, inputEdges[edgeId].second};
+    buildCSR();
+    inNeighborsLocatorEnd = inNeighborsLocator+1;
+    outNeighborsLocatorEnd = outNeighborsLocator+1;
+    layoutVersion = 0;
+}
+
+
+
+Graph::Graph() {
+    graphFilename = "";
+    mappedFile = NULL;
+    newIds = originalIds = NULL;
+    mappedSize = 0;
+    VN = EN = 0;
+    edges = NULL;
+    inNeighbors = outNeighbors = NULL;
+    inNeighborEdgeIds = outNeighborEdgeIds = NULL;
+    inNeighborsLocator = outNeighborsLocator = inNeighborsLocatorEnd = outNeighborsLocatorEnd = NULL;
+    layoutVersion = 0;
 }
 
 
@@ -15,76 +57,405 @@ void Graph::loadGraphFile() {
     double startTime = getCurrentTimeInMs();
     printf("Loading graph file: %s ...\n", graphFilename);
     
-    // open file, read in |V| and |E|
-    freopen(graphFilename, "r", stdin);
-    scanf("%d%d", &VN, &EN);
+    // map the text file, read in |V| and |E|
+    int fd = open(graphFilename, O_RDONLY);
+    struct stat fileStat;
+    fstat(fd, &fileStat);
+    size_t fileSize = fileStat.st_size;
+    char* text = fileSize>0 ? (char*)mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0) : NULL;
+    close(fd);
+    if (text==MAP_FAILED || text==NULL) {
+        printf("! Can not read graph file: %s\n", graphFilename);
+        exit(1);
+    }
+    madvise(text, fileSize, MADV_SEQUENTIAL);
+    char* textEnd = text+fileSize;
+    char* position = text;
+    VN = parseNumber(position, textEnd);
+    EN = parseNumber(position, textEnd);
+    while (position<textEnd && *position!='\n')
+        position++;
 
-    // initialize arrays for storing neighbors
-    inNeighbors = new PerNeighbor[EN];
-    inNeighborsLocator = new EdgeID[VN+1];
-    outNeighbors = new PerNeighbor[EN];
-    outNeighborsLocator = new EdgeID[VN+1];
+    // split edge lines into chunks, each chunk starts at the beginning of a line
+    int chunkNumber = getThreadNumber();
+    vector<char*> chunkStart(chunkNumber+1, textEnd);
+    for (int i=0; i<chunkNumber; i++) {
+        char* start = position+(textEnd-position)*i/chunkNumber;
+        while (i>0 && start<textEnd && *(start-1)!='\n')
+            start++;
+        chunkStart[i] = start;
+    }
 
-    // scanf the graph file line by line
-    VertexID fromId, toId;
+    // count edge lines in each chunk to know where its edge ids start
+    vector<EdgeID> chunkEdgeStart(chunkNumber+1, 0);
+    parallelFor(chunkNumber, [&](int threadId, size_t begin, size_t end) {
+        for (size_t i=begin; i<end; i++)
+            chunkEdgeStart[i+1] = countEdgeLines(chunkStart[i], chunkStart[i+1]);
+    });
+    for (int i=0; i<chunkNumber; i++)
+        chunkEdgeStart[i+1] += chunkEdgeStart[i];
+
+    // parse edges of each chunk in parallel
     edges = new PerEdge[EN];
-    EdgeID i = 0;
-    while (i<EN) {
-        scanf("%d,%d", &fromId, &toId);
-        edges[i] = {i, fromId, toId};
-        i++;
-    }        
-    
-    // store in-neighbors
-    sort(edges, edges+EN, sortByToId);
-    EdgeID curLocator = 0;
-    VertexID curId = 0, id;
-    i = 0;
-    while (i<EN) {
-        id = edges[i].toId;
-        while (curId<=id) {
-            inNeighborsLocator[curId] = curLocator;
-            curId++;
-        }
-        while (i<EN && edges[i].toId==id) {
-            inNeighbors[curLocator] = {edges[i].edgeId, edges[i].fromId};
-            curLocator++;
-            i++;
+    parallelFor(chunkNumber, [&](int threadId, size_t begin, size_t end) {
+        for (size_t i=begin; i<end; i++) {
+            char* linePosition = chunkStart[i];
+            for (EdgeID edgeId=chunkEdgeStart[i]; edgeId<chunkEdgeStart[i+1] && edgeId<EN; edgeId++) {
+                VertexID fromId = parseNumber(linePosition, chunkStart[i+1]);
+                VertexID toId = parseNumber(linePosition, chunkStart[i+1]);
+                edges[edgeId] = {edgeId, fromId, toId};
+                while (linePosition<chunkStart[i+1] && *linePosition!='\n')
+                    linePosition++;
+            }
         }
+    });
+    munmap(text, fileSize);
+    if (chunkEdgeStart[chunkNumber]<EN) {
+        printf("! Graph file has only %d edges, but %d edges are declared\n", chunkEdgeStart[chunkNumber], EN);
+        exit(1);
+    }
+
+    // build in- and out-neighbors
+    buildCSR();
+    
+    double timeCost = getCurrentTimeInMs() - startTime;
+    printf("- Finish. |V|=%d and |E|=%d, time cost: %.2f ms\n", VN, EN, timeCost);
+    logFile<<VN<<","<<EN<<","<<str(timeCost)<<",";
+}
+
+
+
+// parse next unsigned number in text, skipping separators before it
+inline unsigned int Graph::parseNumber(char*& position, char* textEnd) {
+    while (position<textEnd && (*position<'0' || *position>'9'))
+        position++;
+    unsigned int number = 0;
+    while (position<textEnd && *position>='0' && *position<='9') {
+        number = number*10+(*position-'0');
+        position++;
     }
-    while (curId<=VN) {
-        inNeighborsLocator[curId] = curLocator;
-        curId++;
-    }
-
-    // store out-neighbors
-    sort(edges, edges+EN, sortByFromId);
-    curLocator = 0;
-    curId = 0;
-    i = 0;
-    while (i<EN) {
-        id = edges[i].fromId;
-        while (curId<=id) {
-            outNeighborsLocator[curId] = curLocator;
-            curId++;
+    return number;
+}
+
+
+
+// count lines having numbers in [start, end)
+EdgeID Graph::countEdgeLines(char* start, char* end) {
+    EdgeID count = 0;
+    bool hasNumber = false;
+    for (char* position=start; position<end; position++)
+        if (*position=='\n') {
+            count += hasNumber;
+            hasNumber = false;
+        } else if (*position>='0' && *position<='9')
+            hasNumber = true;
+    return count+hasNumber;
+}
+
+
+
+// build CSR of in- and out-neighbors from edges by counting sort
+void Graph::buildCSR() {
+    inNeighbors = new VertexID[EN];
+    inNeighborEdgeIds = new EdgeID[EN];
+    inNeighborsLocator = new EdgeID[VN+1];
+    outNeighbors = new VertexID[EN];
+    outNeighborEdgeIds = new EdgeID[EN];
+    outNeighborsLocator = new EdgeID[VN+1];
+    buildNeighbors(true, outNeighbors, outNeighborEdgeIds, outNeighborsLocator);
+    buildNeighbors(false, inNeighbors, inNeighborEdgeIds, inNeighborsLocator);
+}
+
+
+
+// counting sort edges by fromId (out-neighbors) or toId (in-neighbors), then sort each neighbor list by neighbor ids
+void Graph::buildNeighbors(bool isOut, VertexID* neighbors, EdgeID* neighborEdgeIds, EdgeID* neighborsLocator) {
+
+    // count degrees
+    memset(neighborsLocator, 0, sizeof(EdgeID)*(VN+1));
+    parallelFor(EN, [&](int threadId, size_t begin, size_t end) {
+        for (size_t i=begin; i<end; i++)
+            __atomic_fetch_add(&neighborsLocator[(isOut ? edges[i].fromId : edges[i].toId)+1], 1, __ATOMIC_RELAXED);
+    });
+
+    // prefix sums of degrees as locators
+    for (VertexID u=0; u<VN; u++)
+        neighborsLocator[u+1] += neighborsLocator[u];
+
+    // scatter edges to the lists of their vertices, with neighbors and edge ids together for sorting
+    PerNeighbor* sortedNeighbors = new PerNeighbor[EN];
+    EdgeID* cursor = new EdgeID[VN];
+    memcpy(cursor, neighborsLocator, sizeof(EdgeID)*VN);
+    parallelFor(EN, [&](int threadId, size_t begin, size_t end) {
+        for (size_t i=begin; i<end; i++) {
+            VertexID u = isOut ? edges[i].fromId : edges[i].toId;
+            EdgeID location = __atomic_fetch_add(&cursor[u], 1, __ATOMIC_RELAXED);
+            sortedNeighbors[location] = {edges[i].edgeId, isOut ? edges[i].toId : edges[i].fromId};
         }
-        while (i<EN && edges[i].fromId==id) {
-            outNeighbors[curLocator] = {edges[i].edgeId, edges[i].toId};
-            curLocator++;
-            i++;
+    });
+    delete[] cursor;
+
+    // sort each short list by neighbor ids, ties broken by edge ids for deterministic layout, then split neighbors and edge ids
+    parallelFor(VN, [&](int threadId, size_t begin, size_t end) {
+        for (size_t u=begin; u<end; u++) {
+            sort(sortedNeighbors+neighborsLocator[u], sortedNeighbors+neighborsLocator[u+1], sortByNeighborAndEdgeId);
+            for (EdgeID i=neighborsLocator[u]; i<neighborsLocator[u+1]; i++) {
+                neighbors[i] = sortedNeighbors[i].neighbor;
+                neighborEdgeIds[i] = sortedNeighbors[i].edgeId;
+            }
         }
+    });
+    delete[] sortedNeighbors;
+}
+
+
+
+// check magic string at the beginning of graph file
+bool Graph::isBinaryGraphFile() {
+    char magic[8] = {0};
+    FILE* f = fopen(graphFilename, "rb");
+    if (f==NULL) {
+        printf("! Can not open graph file: %s\n", graphFilename);
+        exit(1);
     }
-    while (curId<=VN) {
-        outNeighborsLocator[curId] = curLocator;
-        curId++;
+    size_t readSize = fread(magic, 1, sizeof(magic), f);
+    fclose(f);
+    return readSize==sizeof(magic) && memcmp(magic, binaryGraphMagic, sizeof(magic))==0;
+}
+
+
+
+// map binary graph file, arrays point into the mapped pages directly
+void Graph::loadBinaryGraphFile() {
+
+    double startTime = getCurrentTimeInMs();
+    printf("Mapping binary graph file: %s ...\n", graphFilename);
+
+    // map the whole file as read-only
+    int fd = open(graphFilename, O_RDONLY);
+    struct stat fileStat;
+    fstat(fd, &fileStat);
+    mappedSize = fileStat.st_size;
+    mappedFile = mmap(NULL, mappedSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mappedFile==MAP_FAILED) {
+        printf("! Can not map graph file: %s\n", graphFilename);
+        exit(1);
     }
 
-    // sort by edge id
-    sort(edges, edges+EN, sortByEdgeId);
-    
+    // check header
+    BinaryGraphHeader* header = (BinaryGraphHeader*)mappedFile;
+    if (mappedSize<sizeof(BinaryGraphHeader) || header->version!=binaryGraphVersion || header->fileSize!=mappedSize) {
+        printf("! Unsupported binary graph file version or broken file, please convert the graph again\n");
+        exit(1);
+    }
+    if (header->vertexIdSize!=sizeof(VertexID) || header->edgeIdSize!=sizeof(EdgeID)) {
+        printf("! Binary graph file is written with different VertexID or EdgeID types\n");
+        exit(1);
+    }
+
+    // locate arrays
+    char* base = (char*)mappedFile;
+    VN = header->VN;
+    EN = header->EN;
+    edges = (PerEdge*)(base+header->edgesOffset);
+    inNeighbors = (VertexID*)(base+header->inNeighborsOffset);
+    outNeighbors = (VertexID*)(base+header->outNeighborsOffset);
+    inNeighborEdgeIds = (EdgeID*)(base+header->inNeighborEdgeIdsOffset);
+    outNeighborEdgeIds = (EdgeID*)(base+header->outNeighborEdgeIdsOffset);
+    inNeighborsLocator = (EdgeID*)(base+header->inNeighborsLocatorOffset);
+    outNeighborsLocator = (EdgeID*)(base+header->outNeighborsLocatorOffset);
+
     double timeCost = getCurrentTimeInMs() - startTime;
     printf("- Finish. |V|=%d and |E|=%d, time cost: %.2f ms\n", VN, EN, timeCost);
     logFile<<VN<<","<<EN<<","<<str(timeCost)<<",";
 }
 
+
+
+// write CSR arrays to a binary graph file, each array is aligned to 64 bytes
+void Graph::writeBinaryGraphFile(const char* outputFilename) {
+
+    // layout of arrays
+    BinaryGraphHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, binaryGraphMagic, sizeof(header.magic));
+    header.version = binaryGraphVersion;
+    header.vertexIdSize = sizeof(VertexID);
+    header.edgeIdSize = sizeof(EdgeID);
+    header.VN = VN;
+    header.EN = EN;
+    unsigned long long position = sizeof(header);
+    unsigned long long* offsets[7] = {&header.edgesOffset, &header.inNeighborsOffset, &header.outNeighborsOffset, 
+                                      &header.inNeighborEdgeIdsOffset, &header.outNeighborEdgeIdsOffset,
+                                      &header.inNeighborsLocatorOffset, &header.outNeighborsLocatorOffset};
+    const char* arrays[7] = {(const char*)edges, (const char*)inNeighbors, (const char*)outNeighbors, 
+                             (const char*)inNeighborEdgeIds, (const char*)outNeighborEdgeIds,
+                             (const char*)inNeighborsLocator, (const char*)outNeighborsLocator};
+    unsigned long long sizes[7] = {sizeof(PerEdge)*EN, sizeof(VertexID)*EN, sizeof(VertexID)*EN, 
+                                   sizeof(EdgeID)*EN, sizeof(EdgeID)*EN,
+                                   sizeof(EdgeID)*(VN+1), sizeof(EdgeID)*(VN+1)};
+    for (short i=0; i<7; i++) {
+        position = (position+63)/64*64;
+        *offsets[i] = position;
+        position += sizes[i];
+    }
+    header.fileSize = position;
+
+    // write header and arrays with paddings
+    FILE* f = fopen(outputFilename, "wb");
+    if (f==NULL) {
+        printf("! Can not write binary graph file: %s\n", outputFilename);
+        exit(1);
+    }
+    char padding[64] = {0};
+    fwrite(&header, sizeof(header), 1, f);
+    position = sizeof(header);
+    for (short i=0; i<7; i++) {
+        fwrite(padding, 1, *offsets[i]-position, f);
+        fwrite(arrays[i], 1, sizes[i], f);
+        position = *offsets[i]+sizes[i];
+    }
+    fclose(f);
+}
+
+
+
+// relabel vertices in an order for locality, where the ith vertex in the order gets new id i
+// - degree: by descending degrees, so that hubs share cache lines
+// - bfs:    by BFS over both directions from vertices of large degrees, so that neighbors get close ids
+// - rcm:    reverse Cuthill-McKee, i.e., reversed BFS from vertices of small degrees visiting neighbors by ascending degrees
+void Graph::reorderVertices(string order) {
+    if (order=="none")
+        return;
+    if (newIds!=NULL) {
+        printf("! Graph is already reordered\n");
+        exit(1);
+    }
+    printf("Reordering vertices by %s ...\n", order.c_str());
+    double startTime = getCurrentTimeInMs();
+
+    // in- plus out-degrees, ties broken by vertex ids
+    vector<EdgeID> degrees(VN);
+    vector<VertexID> vertices(VN);
+    for (VertexID u=0; u<VN; u++) {
+        degrees[u] = inNeighborsLocator[u+1]-inNeighborsLocator[u]+outNeighborsLocator[u+1]-outNeighborsLocator[u];
+        vertices[u] = u;
+    }
+    vector<VertexID> rankedVertices;
+    if (order=="degree") {
+        stable_sort(vertices.begin(), vertices.end(), [&degrees](VertexID a, VertexID b) { return degrees[a]>degrees[b]; });
+        rankedVertices.swap(vertices);
+    } else if (order=="bfs") {
+        stable_sort(vertices.begin(), vertices.end(), [&degrees](VertexID a, VertexID b) { return degrees[a]>degrees[b]; });
+        getBFSOrder(vertices, degrees, false, rankedVertices);
+    } else if (order=="rcm") {
+        stable_sort(vertices.begin(), vertices.end(), [&degrees](VertexID a, VertexID b) { return degrees[a]<degrees[b]; });
+        getBFSOrder(vertices, degrees, true, rankedVertices);
+        reverse(rankedVertices.begin(), rankedVertices.end());
+    } else {
+        printf("! Unknown vertex order: %s\n", order.c_str());
+        exit(1);
+    }
+    newIds = new VertexID[VN];
+    originalIds = new VertexID[VN];
+    for (VertexID i=0; i<VN; i++) {
+        originalIds[i] = rankedVertices[i];
+        newIds[rankedVertices[i]] = i;
+    }
+
+    // relabel edges with the same edge ids, then rebuild CSR in new ids
+    PerEdge* newEdges = new PerEdge[EN];
+    for (EdgeID i=0; i<EN; i++)
+        newEdges[i] = {edges[i].edgeId, newIds[edges[i].fromId], newIds[edges[i].toId]};
+    if (mappedFile!=NULL) {
+        munmap(mappedFile, mappedSize);
+        mappedFile = NULL;
+    } else {
+        delete[] edges;
+        delete[] inNeighbors;
+        delete[] outNeighbors;
+        delete[] inNeighborEdgeIds;
+        delete[] outNeighborEdgeIds;
+        delete[] inNeighborsLocator;
+        delete[] outNeighborsLocator;
+    }
+    edges = newEdges;
+    buildCSR();
+    inNeighborsLocatorEnd = inNeighborsLocator+1;
+    outNeighborsLocatorEnd = outNeighborsLocator+1;
+    layoutVersion++;
+    printf("- Finish. Reordering time: %fs\n", (getCurrentTimeInMs()-startTime)/1000);
+}
+
+
+
+// vertices in BFS order over both directions, starting from unvisited vertices in startOrder, with neighbors by ascending degrees if isSortingNeighbors
+void Graph::getBFSOrder(vector<VertexID>& startOrder, vector<EdgeID>& degrees, bool isSortingNeighbors, vector<VertexID>& order) {
+    vector<bool> isVisited(VN, false);
+    order.clear();
+    order.reserve(VN);
+    for (VertexID& start : startOrder) {
+        if (isVisited[start])
+            continue;
+        isVisited[start] = true;
+        order.push_back(start);
+
+        // the order itself is the BFS queue
+        for (size_t head=order.size()-1; head<order.size(); head++) {
+            VertexID u = order[head];
+            size_t childrenStart = order.size();
+            for (VertexID* neighbors : {outNeighbors, inNeighbors}) {
+                EdgeID* locator = neighbors==outNeighbors ? outNeighborsLocator : inNeighborsLocator;
+                for (EdgeID i=locator[u]; i<locator[u+1]; i++) {
+                    VertexID v = neighbors[i];
+                    if (!isVisited[v]) {
+                        isVisited[v] = true;
+                        order.push_back(v);
+                    }
+                }
+            }
+            if (isSortingNeighbors)
+                stable_sort(order.begin()+childrenStart, order.end(), [&degrees](VertexID a, VertexID b) { return degrees[a]<degrees[b]; });
+        }
+    }
+}
+
+
+
+// new id of a vertex in input files
+inline VertexID Graph::getNewId(VertexID u) {
+    return newIds==NULL ? u : newIds[u];
+}
+
+
+
+// id of a vertex in input files
+inline VertexID Graph::getOriginalId(VertexID u) {
+    return originalIds==NULL ? u : originalIds[u];
+}
+
+
+
+// free arrays, or unmap them for binary graph file
+void Graph::cleanUp() {
+    delete[] newIds;
+    delete[] originalIds;
+    newIds = originalIds = NULL;
+    if (mappedFile!=NULL) {
+        munmap(mappedFile, mappedSize);
+        mappedFile = NULL;
+        return;
+    }
+    delete[] edges;
+    delete[] inNeighbors;
+    delete[] outNeighbors;
+    delete[] inNeighborEdgeIds;
+    delete[] outNeighborEdgeIds;
+    delete[] inNeighborsLocator;
+    delete[] outNeighborsLocator;
+}
+
+
+
 #endif
\ No newline at end of file
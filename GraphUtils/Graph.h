@@ -10,7 +10,7 @@ struct PerEdge {
 };
 
 
-// storing in- or out-neighbors
+// storing in- or out-neighbors with their edges, e.g., when sorting neighbors or in pruned neighbors of verification
 struct PerNeighbor {
     EdgeID edgeId;
     VertexID neighbor;
@@ -23,17 +23,38 @@ struct PerNeighbor {
 
 
 
+// header of binary graph file, followed by the CSR arrays of Graph
+struct BinaryGraphHeader {
+    char magic[8];                                                  // always "EVE-CSR"
+    unsigned int version;                                           // format version, see binaryGraphVersion
+    unsigned int vertexIdSize, edgeIdSize;                          // sizeof(VertexID) and sizeof(EdgeID) when written
+    unsigned int reserved;
+    unsigned long long VN, EN;
+    unsigned long long edgesOffset, inNeighborsOffset, outNeighborsOffset;
+    unsigned long long inNeighborsLocatorOffset, outNeighborsLocatorOffset, fileSize;
+    unsigned long long inNeighborEdgeIdsOffset, outNeighborEdgeIdsOffset;
+};
+const char binaryGraphMagic[8] = "EVE-CSR";
+const unsigned int binaryGraphVersion = 2;
+
+
+
 class Graph {
 
     public:
 
         // basic graph infomation
         Graph(const char* inputGraphFilename);
+        Graph(VertexID inputVN, vector<pair<VertexID, VertexID>>& inputEdges);      // graph from edges in memory, edge ids are their positions
+        Graph();                                                    // empty graph whose arrays are filled by others, e.g., DynamicGraph
         VertexID VN;                                                // |V| of graph
-        EdgeID EN;                                                  // |E| of graph
+        EdgeID EN;                                                  // |E| of graph, or the bound of edge ids and neighbor locations for DynamicGraph
         PerEdge* edges;                                             // store all edges in graph
-        PerNeighbor *inNeighbors, *outNeighbors;                    // neighbors of each vertex, length=EN
+        VertexID *inNeighbors, *outNeighbors;                       // ids of neighbors of each vertex, length=EN
+        EdgeID *inNeighborEdgeIds, *outNeighborEdgeIds;             // ids of edges to the neighbors, sharing locators with neighbors, length=EN
         EdgeID *inNeighborsLocator, *outNeighborsLocator;           // locate where to find the neighbors of a vertex, length=VN
+        EdgeID *inNeighborsLocatorEnd, *outNeighborsLocatorEnd;     // locate where the neighbors of a vertex end, i.e., Locator+1 for static graph
+        int layoutVersion;                                          // changed whenever arrays are moved, so that users reload them
         
         /*
         Compressed Sparse Row (CSR)
@@ -41,34 +62,55 @@ class Graph {
         outNeighbors = [1,2,3,2,3,3] and outNeighborsLocator = [0,3,5],
         which means the out-neighbors of vertex v are: outNeighbors[outNeighborsLocator[v]:outNeighborsLocator[v+1]].
         For example, the out-neighbors of vertex 0 are: outNeighbor[0:3], i.e., [1,2,3]
+        The ids of edges 0->1, 0->2 and 0->3 are outNeighborEdgeIds[0:3] in separate arrays, so that traversals
+        reading only neighbors do not load edge ids into cache.
+        Methods iterate outNeighbors[outNeighborsLocator[v]:outNeighborsLocatorEnd[v]] instead, so that a dynamic graph
+        can leave room between neighbors of vertices.
         */
 
+        // relabel vertices in an order (none/degree/bfs/rcm) for locality of per-vertex arrays, edge ids do not change
+        void reorderVertices(string order);
+        VertexID *newIds, *originalIds;                             // new id of each original id and vice versa, NULL if not reordered
+        inline VertexID getNewId(VertexID u);
+        inline VertexID getOriginalId(VertexID u);
+
+        // write CSR arrays to a binary graph file, which can be mapped directly when loading
+        void writeBinaryGraphFile(const char* outputFilename);
+
+        // free or unmap arrays
+        void cleanUp();
+
     private:
 
         // load graph file
         const char* graphFilename;
         void loadGraphFile();
+        inline unsigned int parseNumber(char*& position, char* textEnd);
+        EdgeID countEdgeLines(char* start, char* end);
 
-};
+        // build in- and out-neighbors from edges
+        void buildCSR();
+        void buildNeighbors(bool isOut, VertexID* neighbors, EdgeID* neighborEdgeIds, EdgeID* neighborsLocator);
+
+        // vertices in BFS order over both directions, starting from unvisited vertices in startOrder
+        void getBFSOrder(vector<VertexID>& startOrder, vector<EdgeID>& degrees, bool isSortingNeighbors, vector<VertexID>& order);
 
+        // map binary graph file, the pages are shared by all processes on the same host
+        bool isBinaryGraphFile();
+        void loadBinaryGraphFile();
+        void* mappedFile;
+        size_t mappedSize;
 
+};
 
-// for sorting edges
 
-bool sortByFromId(PerEdge& a, PerEdge& b) {
-    if (a.fromId==b.fromId)
-        return a.toId<b.toId;
-    return a.fromId<b.fromId;
-}
 
-bool sortByToId(PerEdge& a, PerEdge& b) {
-    if (a.toId==b.toId)
-        return a.fromId<b.fromId;
-    return a.toId<b.toId;
-}
+// for sorting neighbors
 
-bool sortByEdgeId(PerEdge& a, PerEdge& b) {
-    return a.edgeId<b.edgeId;
+bool sortByNeighborAndEdgeId(const PerNeighbor& a, const PerNeighbor& b) {
+    if (a.neighbor==b.neighbor)
+        return a.edgeId<b.edgeId;
+    return a.neighbor<b.neighbor;
 }
 
 
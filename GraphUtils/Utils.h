@@ -12,12 +12,24 @@
 #include <set>
 #include <map>
 #include <queue>
+#include <list>
 #include <stack>
 #include <unordered_map>
 #include <unordered_set>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <functional>
 
 #include <algorithm>
 #include <sys/time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
 #include <math.h>
 #include <random>
 #include<string.h>
@@ -34,9 +46,40 @@ string queryFilename = "TestGraph1.graph_4.query";
 // default hop constraint (>=3)
 short maxLen=4;
 
-// default answer type (exact/upperbound)
+// largest hop constraint of queries, for sizing buffers
+short kMax=4;
+
+// hop constraints with phases specialized at compile time, larger ones use the generic phases
+const short minSpecializedK = 3;
+const short maxSpecializedK = 12;
+
+// default answer type (exact/upperbound), upperbound skips verification and answers all edges in the upper-bound graph
 string answerType = "exact";
 
+// whether to also output undetermined edges of upperbound answers, which are not verified to be in any simple path
+bool tagUndetermined = false;
+
+// whether consecutive queries with the same source or target share a BFS ball
+bool batchQueries = false;
+
+// order of relabeling vertices at load time (none/degree/bfs/rcm), queries and answers still use ids in input files
+string vertexOrder = "none";
+
+// whether BFS expands large frontiers bottom-up, i.e., unvisited vertices look for neighbors in frontier
+bool bottomUpBFS = true;
+
+// memory budget of result cache in MB (0 for no cache), which answers repeated queries without computing them again
+size_t resultCacheSize = 0;
+
+// number of landmarks of hop distance index (0 for no index), which rejects queries whose t is not within k hops from s
+int landmarkNumber = 0;
+
+// default number of threads for answering queries (0 for all cores)
+int numOfThreads = 0;
+
+// number of threads for large frontiers and candidates of one query (0 for cores not used by other queries)
+int intraQueryThreadNumber = 0;
+
 
 
 #if (defined _WIN32) || (defined _WIN64)
@@ -67,6 +110,15 @@ inline double getCurrentTimeInMs() {
 
 
 
+// get monotonic time in ms with nanosecond resolution, for timing short phases
+inline double getPreciseTimeInMs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec*1000 + ts.tv_nsec * 1e-6;
+}
+
+
+
 // get current time for writing logs
 string getCurrentLogTime( )
 {
@@ -101,7 +153,7 @@ string extractFilename(string s) {
 
 
 // output file stream
-ofstream logFile, resultFile, statisticsFile;
+ofstream logFile, statisticsFile;
 
 
 
@@ -121,9 +173,70 @@ void outputBasicLogs(string methodName) {
 
 
 
+// number of threads to use, all cores if not specified
+int getThreadNumber() {
+    if (numOfThreads>0)
+        return numOfThreads;
+    return max(int(thread::hardware_concurrency()), 1);
+}
+
+
+
+// run func(threadId, begin, end) on evenly split ranges of [0, n) in parallel
+void parallelFor(size_t n, function<void(int, size_t, size_t)> func) {
+    int threadNumber = getThreadNumber();
+    if (n<(size_t)threadNumber)
+        threadNumber = max(int(n), 1);
+    vector<thread> threads;
+    for (int i=1; i<threadNumber; i++)
+        threads.push_back(thread(func, i, n*i/threadNumber, n*(i+1)/threadNumber));
+    func(0, 0, n/threadNumber);
+    for (thread& t : threads)
+        t.join();
+}
+
+
+
+// run func(threadId, begin, end) on chunks of [0, n) handed out on demand to threadNumber threads, for ranges of uneven work
+void parallelForChunks(size_t n, int threadNumber, size_t chunkSize, function<void(int, size_t, size_t)> func) {
+    atomic<size_t> nextChunk(0);
+    auto work = [&](int threadId) {
+        for (size_t begin=nextChunk.fetch_add(chunkSize); begin<n; begin=nextChunk.fetch_add(chunkSize))
+            func(threadId, begin, min(begin+chunkSize, n));
+    };
+    vector<thread> threads;
+    for (int i=1; i<threadNumber && (size_t)i*chunkSize<n; i++)
+        threads.push_back(thread(work, i));
+    work(0);
+    for (thread& t : threads)
+        t.join();
+}
+
+
+
+// number of threads for one query when workerNumber queries run at the same time
+int getIntraQueryThreadNumber(int workerNumber) {
+    if (intraQueryThreadNumber>0)
+        return intraQueryThreadNumber;
+    return max(getThreadNumber()/max(workerNumber, 1), 1);
+}
+
+
+
+// read optional argument in the form of --name=value
+string getOption(int argc, char *argv[], string name, string defaultValue) {
+    string prefix = "--"+name+"=";
+    for (int i=1; i<argc; i++)
+        if (string(argv[i]).compare(0, prefix.length(), prefix)==0)
+            return string(argv[i]).substr(prefix.length());
+    return defaultValue;
+}
+
+
+
 // get string of paramters
 string getParaString() {
-    return "-"+str(maxLen);
+    return "-"+str(maxLen)+(answerType=="upperbound" ? "-upperbound" : "");
 }
 
 
@@ -131,17 +244,35 @@ string getParaString() {
 // storing each query
 struct PerQuery {
     VertexID source, target;
+    short k;                                                    // hop constraint of this query
 };
 
 
 
-// load query file
+// load query file, each line is "source,target" or "source,target,k" with default k of maxLen
 void loadQueries(const char* queryFilename, vector<PerQuery>& queries) {
     printf("Loading query file ...\n");
     VertexID fromId, toId;
+    int k;
+    char line[256];
     FILE* f = fopen(queryFilename, "r");
-    while (fscanf(f, "%d,%d", &fromId, &toId) != EOF) 
-        queries.push_back({fromId, toId});
+    if (f==NULL) {
+        printf("! Cannot open query file %s\n", queryFilename);
+        exit(1);
+    }
+    while (fgets(line, sizeof(line), f) != NULL) {
+        int fieldNumber = sscanf(line, "%u,%u,%d", &fromId, &toId, &k);
+        if (fieldNumber<2)
+            continue;
+        if (fieldNumber==2)
+            k = maxLen;
+        if (k<1 || k!=(short)k) {
+            printf("! Invalid hop constraint %d in query file\n", k);
+            exit(1);
+        }
+        queries.push_back({fromId, toId, (short)k});
+        kMax = max(kMax, (short)k);
+    }
     printf("- Finish. %d queries loaded\n", queries.size());
     logFile<<queries.size()<<",";
     fclose(f);
@@ -149,11 +280,4 @@ void loadQueries(const char* queryFilename, vector<PerQuery>& queries) {
 
 
 
-// common variables
-int offset = 0;
-VertexID *forwardFrontier, forwardFrontierEnd, *backwardFrontier, backwardFrontierEnd, *nextFrontier, nextFrontierEnd;
-int *forwardDist, *backwardDist;
-
-
-
 #endif
\ No newline at end of file
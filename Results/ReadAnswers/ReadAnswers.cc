@@ -0,0 +1,29 @@
+#include "../../GraphUtils/AnswerFile.cc"
+using namespace std;
+
+
+int main(int argc, char *argv[]) {    
+
+    // program input parameters
+    if(argc < 2) {
+        cout << "Usage: ./ReadAnswers <Answer File>" << endl;
+        exit(1);
+    }
+    string answerFilename = extractFilename(argv[1]); 
+
+    // print answers of text, binary or zstd answer file as text answers
+    AnswerReader reader(("../Answers/"+answerFilename).c_str());
+    vector<EdgeID> answer;
+    string line = "number of edges,edge ids\n";
+    fwrite(line.c_str(), 1, line.length(), stdout);
+    while (reader.readAnswer(answer)) {
+        line = to_string(answer.size());
+        for (EdgeID& edgeId : answer)
+            line += ","+to_string(edgeId);
+        line += "\n";
+        fwrite(line.c_str(), 1, line.length(), stdout);
+    }
+    reader.close();
+
+    return 0;    
+}